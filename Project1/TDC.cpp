@@ -1,10 +1,14 @@
 #include "TDC.h"
 #include <iostream>
 #include <chrono>
+#include <algorithm>
 int TDCCache::get(const TDCParams& params) {
     if (_capacity <= 0) {
         return -1;
     }
+    if (_use_sketch) {
+        return get_sketch(params);
+    }
     ++_get_count;
     auto it = _table.find(params.target);
 
@@ -32,10 +36,10 @@ int TDCCache::get(const TDCParams& params) {
         // �����ڻ�����
         if (_items.size() >= _capacity) {
             // �������������Ҫ��̭�Ķ��󣬲�Ҫ����ִ����̭����
-            std::vector<int> objectsToEvict;
+            std::vector<int, resource_allocator<int>> objectsToEvict(&_scratch);
 
             // ����ÿ��������¶��ܶȲ��������ܶȱ���
-            std::unordered_map<int, double> densityTable;
+            resource_map<int, double> densityTable(0, &_scratch);
             for (const auto& item : _items) {
                 int objectId = item.first;
                 const std::unordered_map<int, temp>& targetTemperatureTable = temperatureTable[objectId];
@@ -73,8 +77,11 @@ int TDCCache::get(const TDCParams& params) {
                 }
                 _items.erase(tableIt->second);
                 _table.erase(tableIt);
+                ++_eviction_count;
             }
         }
+        // 淘汰用的临时表已析构，暂存区整体回收
+        _scratch.reset();
         // �����ڻ����У����ȶ�����Ϊ 0
         double temperature = 0.0;
         // ��� params.n - 1 �Ƿ�Ϊ����
@@ -124,9 +131,74 @@ double calculateAge(const std::chrono::system_clock::time_point& lastAccessTime)
     // 注意：这里使用计数器差值作为相对时间单位，保持淘汰决策的相对关系不变
     return ageInSeconds;
 }
+// sketch 模式：温度取自 count-min sketch，每进入新周期整体减半（指数衰减），
+// 淘汰时按 温度/(大小*年龄) 计算驻留对象的密度，淘汰低于平均密度的对象。年龄用请求计数作虚拟时间
+int TDCCache::get_sketch(const TDCParams& params) {
+    ++_get_count;
+    ++_clock;
+    if (params.n != _period) {
+        if (_period != 0) {
+            _sketch.age(std::min(31, std::max(1, params.n - _period)));
+        }
+        _period = params.n;
+    }
+    _sketch.add(params.target);
+
+    auto it = _table.find(params.target);
+    if (it != _table.end()) {
+        ++_hit_count;
+        _items.splice(_items.begin(), _items, it->second);
+        resident_meta& meta = _resident[params.target];
+        meta.size = params.size;
+        meta.last_access = _clock;
+        return _items.front().second;
+    }
+
+    if (_items.size() >= _capacity) {
+        std::vector<std::pair<int, double>, resource_allocator<std::pair<int, double>>> densities(&_scratch);
+        densities.reserve(_items.size());
+        double totalDensity = 0.0;
+        for (const auto& item : _items) {
+            const resident_meta& meta = _resident[item.first];
+            double age = static_cast<double>(_clock - meta.last_access);
+            double density = _sketch.estimate(item.first) / (std::max(meta.size, 1.0) * age);
+            densities.emplace_back(item.first, density);
+            totalDensity += density;
+        }
+        double averageDensity = totalDensity / densities.size();
+        size_t evicted = 0;
+        for (const auto& entry : densities) {
+            if (entry.second < averageDensity) {
+                auto tableIt = _table.find(entry.first);
+                _items.erase(tableIt->second);
+                _table.erase(tableIt);
+                _resident.erase(entry.first);
+                ++evicted;
+                ++_eviction_count;
+            }
+        }
+        // 所有密度相同时没有对象低于平均值，退化为淘汰最久未访问的对象
+        if (evicted == 0) {
+            int objectId = _items.back().first;
+            _items.pop_back();
+            _table.erase(objectId);
+            _resident.erase(objectId);
+            ++_eviction_count;
+        }
+    }
+    _scratch.reset();
+
+    _items.emplace_front(params.target, params.target);
+    _table[params.target] = _items.begin();
+    resident_meta& meta = _resident[params.target];
+    meta.size = params.size;
+    meta.last_access = _clock;
+    return _items.front().second;
+}
+
 std::string TDCCache::statics() {
     std::stringstream s;
-    s << "trace:" << _file_name << " TDC_cache:"
+    s << "trace:" << _file_name << (_use_sketch ? " TDC_sketch_cache:" : " TDC_cache:")
         << " cache_size:" << _capacity
         << " request:" << _get_count
         << " hit:" << _hit_count
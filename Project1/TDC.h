@@ -1,9 +1,12 @@
-
+#pragma once
 #include <unordered_map>
 #include <list>
 #include <sstream>
 #include <cstdint>
 #include <chrono>
+#include <vector>
+#include "cmsketch.h"
+#include "memory_resource.h"
 struct temp {
     int n;  // Ψһʶ
     double temperature; // ǰ¶
@@ -23,8 +26,11 @@ struct TDCParams {
 class TDCCache {
 
 public:
-    explicit TDCCache(int c, std::string file_name) :
-        _capacity(c), _file_name(file_name), _hit_count(0), _get_count(0) {}
+    // use_sketch 为 true 时用 count-min sketch 作为温度来源，内存与不同对象数无关
+    explicit TDCCache(int c, std::string file_name, bool use_sketch = false, policy_allocator alloc = current_policy_allocator()) :
+        _resource(make_policy_resource(alloc)), _items(_resource.get()), _table(0, _resource.get()),
+        _capacity(c), _hit_count(0), _get_count(0), _eviction_count(0), _file_name(file_name),
+        _use_sketch(use_sketch), _sketch(use_sketch ? std::max(1, 4 * c) : 1), _resident(0, _resource.get()), _period(0) {}
 
     TDCCache(const TDCCache&) = delete;
     TDCCache& operator=(const TDCCache&) = delete;
@@ -34,6 +40,11 @@ public:
 public:
     int get(const TDCParams& params);
     std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _items.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    int get_sketch(const TDCParams& params);
     //double calculateTemperature(int target);
     int currentCycleAccessCount;  //¼ǰڵķʴ
    //ʹһϣ std::unordered_map<int, TDCParams>ڴ洢ÿ TDCParams ʵ
@@ -42,10 +53,26 @@ public:
     //std::unordered_map<int, double> densityTable;
 private:
     //һ洢ݵ _items
-    std::list<std::pair<int, int>> _items; // (target, cache_addr)
-    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> _table;//ϣ洢ÿλõĹϣ _table
+    using item_list = resource_list<std::pair<int, int>>;
+
+    std::unique_ptr<memory_resource> _resource;  // item_list 与索引表的节点内存
+    monotonic_resource _scratch;                 // 每次淘汰的临时表，淘汰结束后整体回收
+    item_list _items; // (target, cache_addr)
+    resource_map<int, item_list::iterator> _table;//ϣ洢ÿλõĹϣ _table
     int _capacity;
     unsigned int _hit_count;
     unsigned int _get_count;
+    unsigned int _eviction_count;
     std::string _file_name;
+
+    // sketch 模式：近似温度 + 仅驻留对象的大小和最后访问时刻（虚拟时间）
+    struct resident_meta {
+        double size;
+        unsigned int last_access;
+    };
+    bool _use_sketch;
+    CountMinSketch _sketch;
+    resource_map<int, resident_meta> _resident;
+    int _period;  // 上一次看到的周期，周期变化时草图老化
+    unsigned int _clock = 0;  // 虚拟时间（请求计数），不随 reset_stats() 清零
 };
@@ -0,0 +1,274 @@
+#include "adaptive.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+const double kDefaultSampleRate = 0.01;
+const int kMinShadowSize = 64;
+const double kScoreDecay = 0.5;     // 滑动平均中新窗口的权重
+const double kSwitchMargin = 0.005;
+
+uint32_t sample_hash(int block) {
+    uint64_t x = static_cast<uint32_t>(block) * 0x9e3779b97f4a7c15ULL;
+    x ^= x >> 29;
+    return static_cast<uint32_t>(x >> 32);
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) {
+            out.push_back(item);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+AdaptivePolicy::AdaptivePolicy(const std::string& name, int c, const std::string& file_name, policy_allocator alloc,
+    std::vector<std::string> experts, std::vector<std::unique_ptr<CachePolicy>> shadows, double sample_rate) :
+    _name(name), _capacity(c), _file_name(file_name), _allocator(alloc),
+    _experts(std::move(experts)), _cache(make_policy(_experts[0], c, file_name, alloc)), _drain_next(0), _drain_left(0),
+    _shadows(std::move(shadows)),
+    _sample_threshold(sample_rate >= 1.0 ? UINT32_MAX : static_cast<uint32_t>(sample_rate * 4294967296.0)),
+    _sample_rate(sample_rate), _window_accesses(0), _window_hits(_experts.size()),
+    _score(_experts.size(), 0.0), _scored(false), _active_windows(_experts.size()), _active(0), _switches(0),
+    _moved(0), _dropped(0), _retired_evictions(0), _sampled(0) {
+    int shadow_c = std::max(1, static_cast<int>(c * sample_rate + 0.5));
+    _window = static_cast<uint64_t>(std::max(500, 2 * shadow_c));
+}
+
+bool AdaptivePolicy::contains(int block) const {
+    return _cache->contains(block) || (_draining && _draining->contains(block));
+}
+
+// 旧实例中剩余的对象比新实例中的都冷，排在前面
+void AdaptivePolicy::residents(std::vector<int>& out) const {
+    if (_draining) {
+        for (size_t i = _drain_next; i < _drain_order.size(); ++i) {
+            if (_draining->contains(_drain_order[i])) {
+                out.push_back(_drain_order[i]);
+            }
+        }
+    }
+    _cache->residents(out);
+}
+
+bool AdaptivePolicy::get(int block, SimContext& ctx) {
+    bool hit = access(block, ctx);
+    ++_stats.requests;
+    if (hit) {
+        ++_stats.hits;
+    }
+    else {
+        _stats.miss_time_us += miss_cost_model().block_cost_us(ctx.size);
+    }
+    _tally.add(_stats, hit, ctx.size, ctx.last_block);
+    return hit;
+}
+
+void AdaptivePolicy::warm_line(int start, int count, SimContext& ctx) {
+    for (int i = start; i < start + count; ++i) {
+        access(i, ctx);
+    }
+}
+
+// 未抽中的访问只经过一个全尺寸缓存，额外开销只有一次哈希比较
+bool AdaptivePolicy::access(int block, SimContext& ctx) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    if (sample_hash(block) < _sample_threshold) {
+        observe(block, ctx);
+    }
+    if (_draining) {
+        return access_draining(block, ctx);
+    }
+    return _cache->get(block, ctx);
+}
+
+// 新实例未命中时先查旧实例：命中则移过来，否则丢弃旧实例最冷的对象，新实例因此不会淘汰
+bool AdaptivePolicy::access_draining(int block, SimContext& ctx) {
+    if (_cache->contains(block)) {
+        return _cache->get(block, ctx);
+    }
+    bool hit = _draining->erase(block);
+    if (hit) {
+        ++_moved;
+        --_drain_left;
+    }
+    else {
+        drop_coldest();
+    }
+    _cache->get(block, ctx);
+    if (_drain_left == 0) {
+        finish_drain();
+    }
+    return hit;
+}
+
+void AdaptivePolicy::drop_coldest() {
+    while (_drain_next < _drain_order.size()) {
+        if (_draining->erase(_drain_order[_drain_next++])) {
+            ++_dropped;
+            --_drain_left;
+            return;
+        }
+    }
+}
+
+void AdaptivePolicy::finish_drain() {
+    _retired_evictions += _draining->stats().evictions;
+    _draining.reset();
+    std::vector<int>().swap(_drain_order);
+    _drain_next = 0;
+    _drain_left = 0;
+}
+
+void AdaptivePolicy::observe(int block, SimContext& ctx) {
+    ++_sampled;
+    _shadow_ctx.period = ctx.period;
+    _shadow_ctx.size = ctx.size;
+    _shadow_ctx.request_number = ctx.request_number;
+    for (size_t k = 0; k < _shadows.size(); ++k) {
+        if (_shadows[k]->get(block, _shadow_ctx)) {
+            ++_window_hits[k];
+        }
+    }
+    if (++_window_accesses >= _window) {
+        end_window();
+    }
+}
+
+void AdaptivePolicy::end_window() {
+    size_t best = 0;
+    for (size_t k = 0; k < _score.size(); ++k) {
+        double h = 1.0 * _window_hits[k] / _window_accesses;
+        _score[k] = _scored ? (1 - kScoreDecay) * _score[k] + kScoreDecay * h : h;
+        if (_score[k] > _score[best]) {
+            best = k;
+        }
+        _window_hits[k] = 0;
+    }
+    _scored = true;
+    _window_accesses = 0;
+
+    // 上一次切换的旧实例清空前不再切换，切换频率受缓存周转速度限制
+    if (!_draining && best != _active && _score[best] > _score[_active] + kSwitchMargin) {
+        switch_to(best);
+    }
+    ++_active_windows[_active];
+}
+
+void AdaptivePolicy::switch_to(size_t k) {
+    _draining = std::move(_cache);
+    _drain_order.reserve(static_cast<size_t>(_capacity));
+    _draining->residents(_drain_order);
+    _drain_next = 0;
+    _drain_left = _drain_order.size();
+    _cache = make_policy(_experts[k], _capacity, _file_name, _allocator);
+    _active = k;
+    ++_switches;
+    if (_drain_left == 0) {
+        finish_drain();
+    }
+}
+
+void AdaptivePolicy::reset_stats() {
+    _stats = cache_stats();
+    _tally.clear();
+    std::fill(_active_windows.begin(), _active_windows.end(), 0);
+    _switches = 0;
+    _moved = 0;
+    _dropped = 0;
+    _retired_evictions = 0;
+    _sampled = 0;
+    _cache->reset_stats();
+    if (_draining) {
+        _draining->reset_stats();
+    }
+    for (auto& x : _shadows) {
+        x->reset_stats();
+    }
+}
+
+cache_stats AdaptivePolicy::stats() const {
+    cache_stats s = _stats;
+    cache_stats c = _cache->stats();
+    s.resident = c.resident;
+    s.evictions = _retired_evictions + _dropped + c.evictions;
+    s.metadata_bytes = c.metadata_bytes;
+    s.metadata_peak = c.metadata_peak;
+    if (_draining) {
+        cache_stats d = _draining->stats();
+        s.resident += d.resident;
+        s.evictions += d.evictions;
+        s.metadata_bytes += d.metadata_bytes;
+        s.metadata_peak += d.metadata_peak;
+    }
+    for (const auto& x : _shadows) {
+        cache_stats e = x->stats();
+        s.metadata_bytes += e.metadata_bytes;
+        s.metadata_peak += e.metadata_peak;
+    }
+    return s;
+}
+
+std::string AdaptivePolicy::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << " " << _name << ":"
+        << " cache_size:" << _capacity
+        << " request:" << _stats.requests
+        << " hit:" << _stats.hits
+        << " miss:" << _stats.requests - _stats.hits
+        << " hit_rate:" << (_stats.requests ? 1.0 * _stats.hits / _stats.requests : 0.0)
+        << " sample_rate:" << _sample_rate
+        << " sampled:" << _sampled
+        << " switches:" << _switches
+        << " moved:" << _moved
+        << " dropped:" << _dropped
+        << (_draining ? " draining" : "") << std::endl;
+    for (size_t k = 0; k < _experts.size(); ++k) {
+        cache_stats sh = _shadows[k]->stats();
+        s << "  expert " << _experts[k] << ":"
+            << " shadow_hit_rate:" << (sh.requests ? 1.0 * sh.hits / sh.requests : 0.0)
+            << " score:" << _score[k]
+            << " active_windows:" << _active_windows[k]
+            << (k == _active ? " active" : "") << std::endl;
+    }
+    return s.str();
+}
+
+std::unique_ptr<CachePolicy> make_adaptive(const std::string& name, int c, const std::string& file_name,
+    policy_allocator alloc) {
+    size_t colon = name.find(':');
+    if (name.substr(0, colon) != "adaptive") {
+        return nullptr;
+    }
+    std::vector<std::string> names = colon == std::string::npos
+        ? std::vector<std::string>{ "lru", "arc", "lfu", "lirs" }
+        : split(name.substr(colon + 1), '+');
+    if (names.empty()) {
+        return nullptr;
+    }
+
+    double rate = c > 0 ? std::min(1.0, std::max(kDefaultSampleRate, 1.0 * kMinShadowSize / c)) : 1.0;
+    int shadow_c = std::max(1, static_cast<int>(c * rate + 0.5));
+    std::vector<std::unique_ptr<CachePolicy>> shadows;
+    for (const auto& n : names) {
+        // Ceph 分层缓存自行淘汰且无法预知淘汰对象，不能作为专家
+        if (n.compare(0, 8, "adaptive") == 0 || n.compare(0, 9, "ceph_tier") == 0) {
+            return nullptr;
+        }
+        std::unique_ptr<CachePolicy> shadow = make_policy(n, shadow_c, file_name, alloc);
+        if (!shadow || !shadow->supports_exclusive()) {
+            return nullptr;
+        }
+        shadows.push_back(std::move(shadow));
+    }
+    return std::unique_ptr<CachePolicy>(new AdaptivePolicy(name, c, file_name, alloc, names, std::move(shadows), rate));
+}
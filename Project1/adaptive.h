@@ -0,0 +1,83 @@
+#pragma once
+// 自适应策略（ACME 风格）：若干“专家”策略只以缩小的影子运行，一个全尺寸缓存按当前胜出的专家运行
+//   影子：每个专家一个缩小的实例，只接收按 key 哈希抽样的访问（默认 1%，影子至少 64 个对象），
+//         容量按同一比例缩小，其命中率近似该策略在全尺寸缓存上的命中率。开销与抽样率成正比
+//   缓存：胜出专家的全尺寸实例，未抽中的访问只经过它
+// 每个评估窗口结束时，用影子在窗口内的命中率更新各专家得分（指数滑动平均），
+// 得分最高的专家领先当前专家超过 0.5% 时切换。
+// 切换不一次性搬迁：旧实例转为只读，按 residents() 记下从冷到热的顺序。之后新实例未命中时，
+// 旧实例里有该对象则移入新实例（按命中计，带着这次请求的大小），否则从旧实例丢弃最冷的一个腾出位置，
+// 两个实例合计不超过容量；旧实例清空前不再切换。因此专家限于支持独占操作的策略（lru、lru_pool、arc、lfu、lfu_da、lirs、gdsf）
+// 策略名可以带专家列表：adaptive:lru+lfu，默认 lru+arc+lfu+lirs
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "policy.h"
+
+class AdaptivePolicy : public CachePolicy {
+public:
+    AdaptivePolicy(const std::string& name, int c, const std::string& file_name, policy_allocator alloc,
+        std::vector<std::string> experts, std::vector<std::unique_ptr<CachePolicy>> shadows, double sample_rate);
+
+    const char* name() const override { return _name.c_str(); }
+    bool get(int block, SimContext& ctx) override;
+    void warm_line(int start, int count, SimContext& ctx) override;
+    void reset_stats() override;
+    std::string statics() override;
+    cache_stats stats() const override;
+    bool save(snapshot_writer&) const override { return false; }
+    bool load(snapshot_reader&) override { return false; }
+    bool supports_exclusive() const override { return false; }
+    bool contains(int block) const override;
+    int victim() const override { return -1; }
+    bool erase(int) override { return false; }
+    void residents(std::vector<int>& out) const override;
+    void set_eviction_log(std::vector<int>*) override {}
+
+private:
+    bool access(int block, SimContext& ctx);
+    // 旧实例未清空时的访问路径
+    bool access_draining(int block, SimContext& ctx);
+    void observe(int block, SimContext& ctx);
+    void end_window();
+    // 换成专家 k 的新实例，当前实例转为待清空的旧实例
+    void switch_to(size_t k);
+    // 从旧实例丢弃最冷的对象，旧实例清空时释放它
+    void drop_coldest();
+    void finish_drain();
+
+    std::string _name;
+    int _capacity;
+    std::string _file_name;
+    policy_allocator _allocator;             // 影子和各专家实例的分配器
+    std::vector<std::string> _experts;
+    std::unique_ptr<CachePolicy> _cache;     // 当前专家的全尺寸实例
+    std::unique_ptr<CachePolicy> _draining;  // 切换前的实例，清空后释放
+    std::vector<int> _drain_order;           // 旧实例的驻留对象，从冷到热
+    size_t _drain_next;
+    size_t _drain_left;                      // 旧实例剩余的驻留对象数
+    std::vector<std::unique_ptr<CachePolicy>> _shadows;
+    uint32_t _sample_threshold;   // 哈希高 32 位小于该值的 key 进入影子
+    double _sample_rate;
+    uint64_t _window;             // 每个评估窗口的抽样访问数
+    SimContext _shadow_ctx;
+    uint64_t _window_accesses;
+    std::vector<uint64_t> _window_hits;
+    std::vector<double> _score;   // 影子命中率的指数滑动平均
+    bool _scored;                 // 是否已有完整窗口的得分
+    std::vector<uint64_t> _active_windows;  // 每个专家运行全尺寸缓存的窗口数
+    size_t _active;
+    uint64_t _switches;
+    uint64_t _moved;              // 从旧实例移入新实例的对象数
+    uint64_t _dropped;            // 从旧实例丢弃的对象数，计入淘汰
+    uint64_t _retired_evictions;  // 已释放的实例上的淘汰数
+    uint64_t _sampled;
+    cache_stats _stats;
+    request_tally _tally;
+};
+
+// 解析 adaptive[:专家+专家...]，专家名无效或不满足要求时返回 nullptr
+std::unique_ptr<CachePolicy> make_adaptive(const std::string& name, int c, const std::string& file_name,
+    policy_allocator alloc);
@@ -0,0 +1,124 @@
+#include "alloc_counter.h"
+#include <cstdlib>
+#include <new>
+
+// 替换全局 operator new/delete，做计数和记账，分配仍交给 malloc
+// 每块内存前放一个头部，记录归属账户的计数块和请求的字节数，释放时据此扣账
+static std::atomic<uint64_t> g_alloc_count(0);
+static std::atomic<uint64_t> g_alloc_bytes(0);
+static thread_local mem_ledger* t_ledger = nullptr;
+
+namespace {
+
+struct alignas(std::max_align_t) alloc_header {
+    mem_ledger* owner;
+    size_t size;
+};
+
+void* allocate(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* raw = std::malloc(sizeof(alloc_header) + (size ? size : 1));
+    if (!raw) {
+        return nullptr;
+    }
+    alloc_header* h = static_cast<alloc_header*>(raw);
+    h->owner = mem_ledger_acquire(t_ledger);
+    h->size = size;
+    if (h->owner) {
+        h->owner->on_alloc(size);
+    }
+    return h + 1;
+}
+
+void release(void* p) {
+    if (!p) {
+        return;
+    }
+    alloc_header* h = static_cast<alloc_header*>(p) - 1;
+    if (h->owner) {
+        h->owner->on_free(h->size);
+        mem_ledger_release(h->owner);
+    }
+    std::free(h);
+}
+
+} // namespace
+
+uint64_t alloc_count() {
+    return g_alloc_count.load(std::memory_order_relaxed);
+}
+
+uint64_t alloc_bytes() {
+    return g_alloc_bytes.load(std::memory_order_relaxed);
+}
+
+mem_ledger* mem_ledger_acquire(mem_ledger* ledger) {
+    if (ledger) {
+        ledger->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ledger;
+}
+
+void mem_ledger_release(mem_ledger* ledger) {
+    if (ledger && ledger->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ledger->~mem_ledger();
+        std::free(ledger);
+    }
+}
+
+// 计数块直接用 malloc，不经过 operator new，避免记到当前账户上
+mem_account::mem_account() {
+    void* raw = std::malloc(sizeof(mem_ledger));
+    if (!raw) {
+        throw std::bad_alloc();
+    }
+    _ledger = new (raw) mem_ledger();
+    _ledger->current.store(0, std::memory_order_relaxed);
+    _ledger->peak.store(0, std::memory_order_relaxed);
+    _ledger->allocations.store(0, std::memory_order_relaxed);
+    _ledger->refs.store(1, std::memory_order_relaxed);
+}
+
+mem_account::~mem_account() {
+    mem_ledger_release(_ledger);
+}
+
+mem_ledger* current_mem_ledger() {
+    return t_ledger;
+}
+
+mem_scope::mem_scope(mem_account* account) : _prev(t_ledger) {
+    t_ledger = account ? account->ledger() : nullptr;
+}
+
+mem_scope::mem_scope(mem_ledger* ledger) : _prev(t_ledger) {
+    t_ledger = ledger;
+}
+
+mem_scope::~mem_scope() {
+    t_ledger = _prev;
+}
+
+void* operator new(size_t size) {
+    if (void* p = allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    release(p);
+}
@@ -0,0 +1,73 @@
+#pragma once
+// 全局 operator new 计数，用于统计每次操作的分配次数
+// 另外按"归属"记账：在 mem_scope 作用域内发生的分配记到对应的 mem_account 上，
+// 释放时（无论在哪个线程、是否仍在作用域内、账户是否已析构）从同一个账户扣除
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+uint64_t alloc_count();
+uint64_t alloc_bytes();
+
+// 账户的计数块。头部和手工记账处保存的是它而不是账户本身：每块未释放的内存持有一个引用，
+// 账户先析构时计数块继续存活到最后一块内存释放，扣账不会访问已销毁的对象
+struct mem_ledger {
+    std::atomic<size_t> current;
+    std::atomic<size_t> peak;
+    std::atomic<uint64_t> allocations;
+    std::atomic<size_t> refs;
+
+    void on_alloc(size_t n) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t now = current.fetch_add(n, std::memory_order_relaxed) + n;
+        size_t p = peak.load(std::memory_order_relaxed);
+        while (now > p && !peak.compare_exchange_weak(p, now, std::memory_order_relaxed)) {
+        }
+    }
+    void on_free(size_t n) {
+        current.fetch_sub(n, std::memory_order_relaxed);
+    }
+};
+
+// 引用计数加一并原样返回，ledger 可以为 nullptr
+mem_ledger* mem_ledger_acquire(mem_ledger* ledger);
+// 引用计数减一，减到 0 时释放
+void mem_ledger_release(mem_ledger* ledger);
+
+// 一个策略的堆内存账户：当前字节数、峰值字节数（不含分配器自身的开销）
+class mem_account {
+public:
+    mem_account();
+    ~mem_account();
+    mem_account(const mem_account&) = delete;
+    mem_account& operator=(const mem_account&) = delete;
+
+    size_t current() const { return _ledger->current.load(std::memory_order_relaxed); }
+    size_t peak() const { return _ledger->peak.load(std::memory_order_relaxed); }
+    uint64_t allocations() const { return _ledger->allocations.load(std::memory_order_relaxed); }
+    // 峰值从当前值重新开始统计
+    void reset_peak() { _ledger->peak.store(current(), std::memory_order_relaxed); }
+
+    mem_ledger* ledger() const { return _ledger; }
+
+private:
+    mem_ledger* _ledger;
+};
+
+// 当前线程的记账目标，nullptr 表示不记账
+mem_ledger* current_mem_ledger();
+
+// RAII：作用域内本线程的分配记到 account 上，可嵌套。
+// 工作线程沿用创建者的账户时，在创建处 mem_ledger_acquire(current_mem_ledger())，
+// 线程内用 mem_scope(ledger) 进入，线程结束后 mem_ledger_release
+class mem_scope {
+public:
+    explicit mem_scope(mem_account* account);
+    explicit mem_scope(mem_ledger* ledger);
+    ~mem_scope();
+    mem_scope(const mem_scope&) = delete;
+    mem_scope& operator=(const mem_scope&) = delete;
+
+private:
+    mem_ledger* _prev;
+};
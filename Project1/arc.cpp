@@ -12,99 +12,246 @@ int ARCCache::get(int target) {
     ++_get_count;
     auto it = _table.find(target);
     if (it != _table.end()) {
-
         // case1
-        if (it->second->lru_type == T1 || it->second->lru_type == T2) {
-            move_to_lru(it->second, T2);
-            assert_c();
-            ++_hit_count;
-            return it->second->addr;
-        }
-
-        // case2
-        if (it->second->lru_type == B1) {
-            auto t = _b1.size() >= _b2.size() ? 1 : _b2.size() / (double)_b1.size();
-            _p = min(_p + t, _c);
-            replace(false);
-            move_to_lru(it->second, T2);
-            it->second->addr = target;
-            assert_c();
-            return it->second->addr;
-        }
+        move_to_lru(it->second, T2);
+        assert_c();
+        ++_hit_count;
+        return it->second->addr;
+    }
 
-        // case3
-        if (it->second->lru_type == B2) {
-            auto t = _b2.size() >= _b1.size() ? 1 : _b1.size() / (double)_b2.size();
-            _p = max(_p - t, 0);
-            replace(true);
-            move_to_lru(it->second, T2);
-            it->second->addr = target;
-            assert_c();
-            return it->second->addr;
-        }
+    // case2：命中 B1 的指纹
+    if (_b1.contains(target)) {
+        auto t = _b1.size() >= _b2.size() ? 1 : _b2.size() / (double)_b1.size();
+        _p = min(_p + t, _c);
+        replace(false);
+        _b1.erase(target);
+        return insert_entry(target, T2);
+    }
 
+    // case3：命中 B2 的指纹
+    if (_b2.contains(target)) {
+        auto t = _b2.size() >= _b1.size() ? 1 : _b1.size() / (double)_b2.size();
+        _p = max(_p - t, 0);
+        replace(true);
+        _b2.erase(target);
+        return insert_entry(target, T2);
     }
-    else
-    {
-        // ���δ�ҵ�Ŀ�����ζ�Ż���δ����
-        _miss_count++;  // ����δ���м�����
 
-        // case4
-        assert(_t1.size() + _b1.size() <= _c);
-        if (_t1.size() + _b1.size() == _c) {
-            // case4.1
-            if (_t1.size() < _c) {
-                _table.erase(_b1.back()->target);
-                _b1.pop_back();
-                replace(false);
-            }
-            else {
-                _table.erase(_t1.back()->target);
-                _t1.pop_back();
-            }
+    // ���δ�ҵ�Ŀ�����ζ�Ż���δ����
+    _miss_count++;  // ����δ���м�����
+
+    // case4
+    assert(_t1.size() + _b1.size() <= _c);
+    if (_t1.size() + _b1.size() == _c) {
+        // case4.1
+        if (_t1.size() < _c) {
+            _b1.pop_back();
+            replace(false);
         }
         else {
-            // case 4.2
-            assert(_t1.size() + _b1.size() < _c);
-            auto size = _t1.size() + _t2.size() + _b1.size() + _b2.size();
-            if (size >= _c) {
-                if (size == _c * 2) {
-                    _table.erase(_b2.back()->target);
-                    _b2.pop_back();
-                }
-                replace(false);
+            if (_eviction_log) {
+                _eviction_log->push_back(_t1.back()->target);
+            }
+            _table.erase(_t1.back()->target);
+            _t1.pop_back();
+            ++_eviction_count;
+        }
+    }
+    else {
+        // case 4.2
+        assert(_t1.size() + _b1.size() < _c);
+        auto size = _t1.size() + _t2.size() + _b1.size() + _b2.size();
+        if (size >= _c) {
+            if (size == _c * 2) {
+                _b2.pop_back();
             }
+            replace(false);
         }
-       
     }
-    std::shared_ptr<ArcEntry> entry = std::make_shared<ArcEntry>();
+    return insert_entry(target, T1);
+}
+
+int ARCCache::insert_entry(int target, LruType type) {
+    std::shared_ptr<ArcEntry> entry = std::allocate_shared<ArcEntry>(resource_allocator<ArcEntry>(_resource.get()));
     entry->target = target;
     entry->addr = target;
-    entry->lru_type = T1;
-        _t1.push_front(entry);
-        entry->iter = _t1.begin();
+    entry->lru_type = type;
+    auto dst_list = _list_table[type];
+    dst_list->push_front(entry);
+    entry->iter = dst_list->begin();
     _table[target] = entry;
     assert_c();
-    return _t1.front()->addr;
-
+    return entry->addr;
 }
 
+// 被替换的驻留对象离开 T1/T2，只把指纹留在 B1/B2。
+// erase() 之后 T1/T2 可能比 ARC 的不变量所设想的更空：T2 为空时从 T1 替换，两者都空时不替换
 void ARCCache::replace(bool in_b2) {
+    // 缓存未满时不淘汰：单独运行的 ARC 只在满时才会走到这里，
+    // 被 erase 过的 ARC（多级缓存、自适应策略的专家）目录可能已满而缓存未满
+    if (_t1.size() + _t2.size() < static_cast<size_t>(_c)) {
+        return;
+    }
+    ++_eviction_count;
     if (_t1.size() != 0 &&
-        ((_t1.size() > _p) || (in_b2 && _t1.size() == _p))) {
+        (_t2.empty() || (_t1.size() > _p) || (in_b2 && _t1.size() == _p))) {
         assert(!_t1.empty());
         auto entry = _t1.back();
-        entry->addr = -1;
         assert(entry->lru_type == T1);
-        move_to_lru(entry, B1);
+        _t1.pop_back();
+        _table.erase(entry->target);
+        _b1.push_front(entry->target);
+        if (_eviction_log) {
+            _eviction_log->push_back(entry->target);
+        }
     }
     else {
         assert(!_t2.empty());
         auto entry = _t2.back();
-        entry->addr = -1;
         assert(entry->lru_type == T2);
-        move_to_lru(entry, B2);
+        _t2.pop_back();
+        _table.erase(entry->target);
+        _b2.push_front(entry->target);
+        if (_eviction_log) {
+            _eviction_log->push_back(entry->target);
+        }
+    }
+}
+
+bool ARCCache::contains(int target) const {
+    return _table.find(target) != _table.end();
+}
+
+// 与 get() 未命中路径及 replace(false) 的选择保持一致
+int ARCCache::victim() const {
+    if (_t1.size() + _t2.size() < static_cast<size_t>(_c)) {
+        return -1;
+    }
+    bool need_replace = false;
+    if (_t1.size() + _b1.size() == _c) {
+        if (_t1.size() >= _c) {
+            return _t1.back()->target;
+        }
+        need_replace = true;
+    }
+    else if (_t1.size() + _t2.size() + _b1.size() + _b2.size() >= _c) {
+        need_replace = true;
     }
+    if (!need_replace) {
+        return -1;
+    }
+    if (_t1.size() != 0 && (_t2.empty() || _t1.size() > _p)) {
+        return _t1.back()->target;
+    }
+    return _t2.empty() ? -1 : _t2.back()->target;
+}
+
+// 按 victim() 的规则连续淘汰：T1 多于 p 时取 T1 尾部，否则取 T2 尾部（p 保持不变）
+void ARCCache::residents(std::vector<int>& out) const {
+    auto t1 = _t1.rbegin();
+    auto t2 = _t2.rbegin();
+    size_t n1 = _t1.size();
+    size_t n2 = _t2.size();
+    while (n1 + n2 > 0) {
+        if (n1 > 0 && (n2 == 0 || n1 > _p)) {
+            out.push_back((*t1++)->target);
+            --n1;
+        }
+        else {
+            out.push_back((*t2++)->target);
+            --n2;
+        }
+    }
+}
+
+bool ARCCache::erase(int target) {
+    auto it = _table.find(target);
+    if (it == _table.end()) {
+        return false;
+    }
+    _list_table[it->second->lru_type]->erase(it->second->iter);
+    _table.erase(it);
+    return true;
+}
+
+void ARCCache::save_list(snapshot_writer& w, const resource_list<ArcEntryPtr>& list) const {
+    std::vector<int32_t> items;
+    items.reserve(list.size() * 2);
+    for (const auto& entry : list) {
+        items.push_back(entry->target);
+        items.push_back(entry->addr);
+    }
+    w.put_vector(items);
+}
+
+// 按保存时的顺序追加到列表尾部，哈希表已提前 reserve
+bool ARCCache::load_list(snapshot_reader& r, LruType type) {
+    std::vector<int32_t> items;
+    if (!r.get_vector(items) || items.size() % 2 != 0) {
+        return false;
+    }
+    auto dst_list = _list_table[type];
+    for (size_t i = 0; i < items.size(); i += 2) {
+        std::shared_ptr<ArcEntry> entry = std::allocate_shared<ArcEntry>(resource_allocator<ArcEntry>(_resource.get()));
+        entry->target = items[i];
+        entry->addr = items[i + 1];
+        entry->lru_type = type;
+        dst_list->push_back(entry);
+        entry->iter = std::prev(dst_list->end());
+        _table[entry->target] = entry;
+    }
+    return true;
+}
+
+void ARCCache::save(snapshot_writer& w) const {
+    w.begin("arc");
+    w.put<int32_t>(_c);
+    w.put<double>(_p);
+    w.put<uint32_t>(_hit_count);
+    w.put<uint32_t>(_get_count);
+    w.put<int32_t>(_miss_count);
+    w.put<uint32_t>(_eviction_count);
+    w.put<uint64_t>(_t1.size() + _t2.size());
+    save_list(w, _t1);
+    save_list(w, _t2);
+    _b1.save(w);
+    _b2.save(w);
+}
+
+bool ARCCache::load(snapshot_reader& r) {
+    int32_t c = 0, miss = 0;
+    double p = 0;
+    uint32_t hit = 0, get = 0, evicted = 0;
+    uint64_t resident = 0;
+    if (!r.expect("arc") || !r.get(c) || !r.get(p) || !r.get(hit) || !r.get(get) || !r.get(miss) ||
+        !r.get(evicted) || !r.get(resident) || c != _c || resident > static_cast<uint64_t>(_c)) {
+        return false;
+    }
+    _t1.clear();
+    _t2.clear();
+    _table.clear();
+    _table.reserve(static_cast<size_t>(resident));
+    if (!load_list(r, T1) || !load_list(r, T2) || !_b1.load(r) || !_b2.load(r)) {
+        return false;
+    }
+    _p = p;
+    _hit_count = hit;
+    _get_count = get;
+    _miss_count = miss;
+    _eviction_count = evicted;
+    assert_c();
+    return true;
+}
+
+bool ARCCache::save(const std::string& path) const {
+    snapshot_writer w;
+    save(w);
+    return w.write_file(path);
+}
+
+bool ARCCache::load(const std::string& path) {
+    snapshot_reader r;
+    return r.read_file(path) && load(r);
 }
 
 std::string ARCCache::statics() {
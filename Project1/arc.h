@@ -1,10 +1,13 @@
-
+#pragma once
 #include <cassert>
 #include <list>
 #include <unordered_map>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include "ghostlist.h"
+#include "snapshot.h"
+#include "memory_resource.h"
 //LruType ö�٣��о��˲�ͬ���͵� LRU���������ʹ�ã��б���T1��B1��T2��B2��None��
 enum LruType {
     T1,
@@ -22,20 +25,21 @@ struct ArcEntry {
     int target;
     int addr;
     LruType lru_type;
-    std::list<ArcEntryPtr>::iterator iter;
+    resource_list<ArcEntryPtr>::iterator iter;
 };
 //ARCCache �ࣺʵ���� ARC �����㷨
 class ARCCache {
 
 public:
     //// ���캯������ʼ��������������ݽṹ
-    explicit ARCCache(int c, std::string file_name) : _c(c), _p(0),
-        _file_name(file_name), _hit_count(0), _get_count(0),_miss_count(0) {
+    explicit ARCCache(int c, std::string file_name, policy_allocator alloc = current_policy_allocator()) :
+        _resource(make_policy_resource(alloc)),
+        _t1(_resource.get()), _t2(_resource.get()), _b1(_resource.get()), _b2(_resource.get()),
+        _table(0, _resource.get()), _c(c), _p(0),
+        _hit_count(0), _get_count(0), _eviction_count(0), _miss_count(0), _file_name(file_name) {
 
         _list_table[T1] = &_t1;
         _list_table[T2] = &_t2;
-        _list_table[B1] = &_b1;
-        _list_table[B2] = &_b2;
     }
     //// ���ÿ������캯���͸�ֵ�������ȷ����һʵ��
     ARCCache(const ARCCache&) = delete;
@@ -48,28 +52,45 @@ public:
     int get(int target);
     // ���ػ����ͳ����Ϣ
     std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _t1.size() + _t2.size(); }
+    // 计数器清零（预热结束时调用），缓存内容和 p 不变
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; _miss_count = 0; }
+    // 对象是否在 T1/T2 中（不含幽灵列表）
+    bool contains(int target) const;
+    // 下一次未命中时将被淘汰到 B1/B2 的对象，无需淘汰时返回 -1
+    int victim() const;
+    // 从 T1/T2 移除（多级缓存独占模式下对象被提升到上一级），不留幽灵记录
+    bool erase(int target);
+    // 驻留对象按淘汰先后追加到 out，顺序与按当前 p 连续淘汰一致
+    void residents(std::vector<int>& out) const;
+    // 非空时把每个被淘汰的对象追加到 log（erase 不算淘汰），多级缓存独占模式按它降级
+    void set_eviction_log(std::vector<int>* log) { _eviction_log = log; }
+    // 快照：保存 p、T1/T2 的条目顺序和 B1/B2 的指纹，加载时批量重建条目与索引
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+    void save(snapshot_writer& w) const;
+    bool load(snapshot_reader& r);
 
 private:
     // ����Ŀ�ƶ���ָ���� LRU �б�
+    // T1/T2 中的条目都记录了自身迭代器，直接 splice
     inline void move_to_lru(const ArcEntryPtr& entry, const LruType& new_type) {
         auto src_list = _list_table[entry->lru_type];
         auto dst_list = _list_table[new_type];
         assert(src_list != nullptr && dst_list != nullptr);
 
-        auto it = src_list->begin();
-        for (; it != src_list->end(); ++it) {
-            if (it->get() == entry.get()) {
-                break;
-            }
-        }
-        assert(it != src_list->end());
-
-        dst_list->splice(dst_list->begin(), *src_list, it);
+        dst_list->splice(dst_list->begin(), *src_list, entry->iter);
         entry->lru_type = new_type;
         entry->iter = dst_list->begin();
     }
     // ִ���滻����
     void replace(bool in_b2);
+    // 新建条目放到 T1 或 T2 的头部
+    int insert_entry(int target, LruType type);
+    void save_list(snapshot_writer& w, const resource_list<ArcEntryPtr>& list) const;
+    bool load_list(snapshot_reader& r, LruType type);
     // ������������黺���С�Ƿ�����涨
     inline void assert_c() {
         assert(_t1.size() + _t2.size() <= _c);
@@ -79,14 +100,16 @@ private:
     }
 
 private:
+    std::unique_ptr<memory_resource> _resource;  // 条目、T1/T2 链表与哈希表的内存
     // ��ͬ LRU �б�
-    std::list<ArcEntryPtr> _t1;
-    std::list<ArcEntryPtr> _b1;
-    std::list<ArcEntryPtr> _t2;
-    std::list<ArcEntryPtr> _b2;
+    resource_list<ArcEntryPtr> _t1;
+    resource_list<ArcEntryPtr> _t2;
+    // 幽灵列表只保存被淘汰对象的指纹
+    GhostList _b1;
+    GhostList _b2;
     // ӳ�䲻ͬ LRU �б�������
-    std::unordered_map<LruType, std::list<ArcEntryPtr>*> _list_table;
-    std::unordered_map<int, ArcEntryPtr> _table;
+    std::unordered_map<LruType, resource_list<ArcEntryPtr>*> _list_table;
+    resource_map<int, ArcEntryPtr> _table;  // 只索引 T1/T2 中的驻留对象
     // ��������
     int _c;
     // P ����
@@ -94,9 +117,11 @@ private:
     // ���д����ͷ��ʴ���
     unsigned int _hit_count;
     unsigned int _get_count;
+    unsigned int _eviction_count;  // 离开 T1/T2 的对象数
     int _miss_count;  // �����ӵ�δ���м�����
 
     // �ļ���
     std::string _file_name;
 
+    std::vector<int>* _eviction_log = nullptr;
 };
@@ -0,0 +1,299 @@
+#include "bench.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+#include "memory_resource.h"
+#include "policy.h"
+#include "sim.h"
+#include "workload.h"
+
+namespace {
+
+// 每个策略计时的操作数/缓存大小上限（预热不受限，缓存大小上限同时约束预热耗时）：SCORE 每次未命中要扫描全部 trace_records，
+// TDC 和 Ceph 分层缓存每次淘汰扫描 O(c) 个对象，规模太大时跳过；
+// tdc2 只对抽样候选打分，但每个对象的元数据较多，限制在 1e6 以内
+struct policy_budget {
+    const char* name;
+    uint64_t max_ops;
+    int max_cache_size;
+};
+
+const policy_budget kBudgets[] = {
+    { "score", 2000, 1000 },
+    { "tdc", 20000, 10000 },
+    { "tdc_sketch", 20000, 10000 },
+    { "ceph_tier", 20000, 100000 },
+    { "tdc2", 200000, 1000000 },
+};
+
+struct bench_options {
+    uint64_t ops = 1000000;
+    uint64_t seed = 42;
+    std::vector<int> sizes = { 1000, 10000, 100000, 1000000, 10000000 };
+    std::vector<std::string> policies;
+    std::vector<std::string> workloads = { "uniform", "zipf0.6", "zipf0.9", "zipf1.2", "scan", "loop", "mixed" };
+    std::vector<std::string> allocators = { "malloc" };
+    std::string out;
+};
+
+struct bench_result {
+    std::string policy;
+    std::string workload;
+    std::string allocator;
+    int cache_size;
+    uint64_t warmup_ops;
+    uint64_t ops;
+    double ns_per_op;
+    double ops_per_sec;
+    double allocs_per_op;
+    double hit_rate;
+    uint64_t metadata_bytes;  // 测量结束时策略占用的堆内存
+    uint64_t metadata_peak;
+    double bytes_per_entry;
+};
+
+std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            out.push_back(item);
+        }
+    }
+    return out;
+}
+
+// 热点集合相对缓存大小：循环略大于缓存，其余为缓存的 4 倍
+uint64_t universe_of(WorkloadKind kind, int c) {
+    if (kind == WL_LOOP) {
+        return static_cast<uint64_t>(c) * 5 / 4 + 1;
+    }
+    return static_cast<uint64_t>(c) * 4;
+}
+
+// 在同一 (负载, 缓存大小) 上预先生成访问序列，所有策略共用，生成开销不计入测量
+// 负载描述无法识别时返回 false
+bool make_keys(const std::string& workload, int c, uint64_t count, uint64_t seed, std::vector<int>* keys) {
+    WorkloadKind kind;
+    double alpha;
+    if (!KeyStream::parse(workload, &kind, &alpha)) {
+        return false;
+    }
+    KeyStream stream(kind, universe_of(kind, c), alpha, seed);
+    keys->resize(count);
+    for (auto& k : *keys) {
+        k = stream.next();
+    }
+    return true;
+}
+
+// 把请求写入上下文：TDC 周期每 kPeriodRequests 个请求推进一次，SCORE 需要的记录按需追加
+inline void advance(SimContext& ctx, int block, uint64_t request, bool records) {
+    if (request % kPeriodRequests == 0) {
+        ++ctx.period;
+    }
+    if (records) {
+        trace_line l;
+        l.starting_block = block;
+        l.size_of_blocks = 1;
+        l.ignore = 0;
+        l.request_number = block;
+        l.access_count = 0;
+        l.current_time = static_cast<time_t>(request);
+        ctx.trace_records.push_back(l);
+    }
+}
+
+bench_result run_one(const std::string& policy, const std::string& workload, int c, policy_allocator alloc,
+    const std::vector<int>& keys, uint64_t warmup, uint64_t ops) {
+    std::unique_ptr<CachePolicy> p = make_policy(policy, c, "bench", alloc);
+    SimContext ctx;
+    bool records = p->uses_trace_records();
+    if (records) {
+        ctx.trace_records.reserve(warmup + ops);
+    }
+
+    // 预热：填满缓存后再开始计时
+    uint64_t request = 0;
+    for (uint64_t i = 0; i < warmup; ++i, ++request) {
+        advance(ctx, keys[i], request, records);
+        p->get(keys[i], ctx);
+    }
+
+    uint64_t hits = 0;
+    uint64_t allocs_before = alloc_count();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = warmup; i < warmup + ops; ++i, ++request) {
+        advance(ctx, keys[i], request, records);
+        hits += p->get(keys[i], ctx) ? 1 : 0;
+    }
+    auto end = std::chrono::steady_clock::now();
+    uint64_t allocs = alloc_count() - allocs_before;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    bench_result r;
+    r.policy = policy;
+    r.workload = workload;
+    r.allocator = policy_allocator_name(alloc);
+    r.cache_size = c;
+    r.warmup_ops = warmup;
+    r.ops = ops;
+    r.ns_per_op = ns / ops;
+    r.ops_per_sec = ns > 0 ? ops * 1e9 / ns : 0;
+    r.allocs_per_op = 1.0 * allocs / ops;
+    r.hit_rate = 1.0 * hits / ops;
+    cache_stats st = p->stats();
+    r.metadata_bytes = st.metadata_bytes;
+    r.metadata_peak = st.metadata_peak;
+    r.bytes_per_entry = st.resident ? 1.0 * st.metadata_bytes / st.resident : 0.0;
+    return r;
+}
+
+void write_json(std::ostream& os, const bench_options& opt, const std::vector<bench_result>& results) {
+    os << "{\n  \"version\": 1,\n  \"seed\": " << opt.seed << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        os << "    {\"policy\": \"" << r.policy << "\", \"workload\": \"" << r.workload
+            << "\", \"allocator\": \"" << r.allocator
+            << "\", \"cache_size\": " << r.cache_size
+            << ", \"warmup_ops\": " << r.warmup_ops
+            << ", \"ops\": " << r.ops
+            << ", \"ns_per_op\": " << r.ns_per_op
+            << ", \"ops_per_sec\": " << r.ops_per_sec
+            << ", \"allocs_per_op\": " << r.allocs_per_op
+            << ", \"hit_rate\": " << r.hit_rate
+            << ", \"metadata_bytes\": " << r.metadata_bytes
+            << ", \"metadata_peak\": " << r.metadata_peak
+            << ", \"bytes_per_entry\": " << r.bytes_per_entry << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+void usage(const char* prog) {
+    std::cerr << "usage: " << prog << " --bench [--ops N] [--sizes a,b,...] [--policies p,...]\n"
+        << "                 [--workloads w,...] [--alloc a,...] [--seed S] [--out file.json]\n"
+        << "       workloads: uniform zipf<alpha> scan loop mixed\n"
+        << "       allocators: malloc pool pool_huge (policy container allocator, default malloc)\n";
+}
+
+} // namespace
+
+int run_bench(int argc, char** argv) {
+    bench_options opt;
+    opt.policies = policy_names();
+    for (int i = 2; i < argc; ++i) {  // argv[1] 是 --bench
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--ops") {
+            opt.ops = std::stoull(value);
+        }
+        else if (arg == "--seed") {
+            opt.seed = std::stoull(value);
+        }
+        else if (arg == "--sizes") {
+            opt.sizes.clear();
+            for (const auto& s : split(value)) {
+                opt.sizes.push_back(std::stoi(s));
+            }
+        }
+        else if (arg == "--policies") {
+            opt.policies = split(value);
+        }
+        else if (arg == "--workloads") {
+            opt.workloads = split(value);
+        }
+        else if (arg == "--alloc") {
+            opt.allocators = split(value);
+        }
+        else if (arg == "--out") {
+            opt.out = value;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    for (const auto& policy : opt.policies) {
+        if (!make_policy(policy, 1, "bench")) {
+            std::cerr << "unknown policy: " << policy << std::endl;
+            return 1;
+        }
+    }
+    for (const auto& workload : opt.workloads) {
+        WorkloadKind kind;
+        double alpha;
+        if (!KeyStream::parse(workload, &kind, &alpha)) {
+            std::cerr << "unknown workload: " << workload << std::endl;
+            return 1;
+        }
+    }
+    std::vector<policy_allocator> allocators;
+    for (const auto& name : opt.allocators) {
+        policy_allocator kind;
+        if (!parse_policy_allocator(name, &kind)) {
+            std::cerr << "unknown allocator: " << name << std::endl;
+            return 1;
+        }
+        allocators.push_back(kind);
+    }
+
+    std::vector<bench_result> results;
+    for (int c : opt.sizes) {
+        for (const auto& workload : opt.workloads) {
+            // 预热至少填满两倍缓存容量；慢策略的预算只限制计时部分，测量总在满缓存上进行
+            uint64_t max_warmup = 2ULL * c;
+            std::vector<int> keys;
+            if (!make_keys(workload, c, max_warmup + opt.ops, opt.seed, &keys)) {
+                std::cerr << "unknown workload: " << workload << std::endl;
+                return 1;
+            }
+            for (const auto& policy : opt.policies) {
+                uint64_t ops = opt.ops;
+                uint64_t warmup = max_warmup;
+                bool skip = false;
+                for (const auto& b : kBudgets) {
+                    if (policy == b.name) {
+                        skip = c > b.max_cache_size;
+                        ops = std::min(ops, b.max_ops);
+                    }
+                }
+                if (skip) {
+                    std::cerr << "skip " << policy << " cache_size:" << c << std::endl;
+                    continue;
+                }
+                for (policy_allocator kind : allocators) {
+                    results.push_back(run_one(policy, workload, c, kind, keys, warmup, ops));
+                    const bench_result& r = results.back();
+                    std::cerr << r.policy << " " << r.workload << " cache_size:" << c << " alloc:" << r.allocator
+                        << " ns/op:" << r.ns_per_op << " allocs/op:" << r.allocs_per_op
+                        << " hit_rate:" << r.hit_rate << " bytes/entry:" << r.bytes_per_entry << std::endl;
+                }
+            }
+        }
+    }
+
+    if (opt.out.empty()) {
+        write_json(std::cout, opt, results);
+    }
+    else {
+        std::ofstream os(opt.out);
+        if (!os) {
+            std::cerr << "can't open " << opt.out << std::endl;
+            return -1;
+        }
+        write_json(os, opt, results);
+    }
+    return 0;
+}
@@ -0,0 +1,3 @@
+#pragma once
+// 各策略 get() 的微基准测试：SCORE.exe --bench [选项]，结果输出为 JSON
+int run_bench(int argc, char** argv);
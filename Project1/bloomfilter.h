@@ -1,17 +1,39 @@
-#include <set>
-//һ򵥵ļϣstd::setװ,ȷеش洢ͲѯԪ
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "snapshot.h"
+//Ĳ¡λ + k ϣ˫عϣȷλС
 class BloomFilter {
 public:
-	BloomFilter(int size) {
+	BloomFilter(int size, double fpp = 0.01) {
 		capacity = size;//ʵָǹԴ洢Ԫ
+		double n = std::max(1, size);
+		double m = -n * std::log(fpp) / (std::log(2.0) * std::log(2.0));
+		words.assign((static_cast<size_t>(m) + 63) / 64, 0);
+		nbits = words.size() * 64;
+		k = std::max(1, static_cast<int>(std::lround(m / n * std::log(2.0))));
 	}
 	void setBit(unsigned int count) {
-		s.insert(count);
-		--capacity;//ʵֻǼ򵥵Ԫص std::set 
+		uint64_t h = hash(count);
+		uint64_t h1 = h & 0xffffffff, h2 = (h >> 32) | 1;
+		for (int i = 0; i < k; ++i) {
+			uint64_t b = (h1 + i * h2) % nbits;
+			words[b >> 6] |= 1ULL << (b & 63);
+		}
+		--capacity;//ÿһռһɵֻ
 	}
 
-	bool checkBit(unsigned int count) {
-		return s.find(count) != s.end();//ԪأcountǷѾڼ s 
+	bool checkBit(unsigned int count) const {
+		uint64_t h = hash(count);
+		uint64_t h1 = h & 0xffffffff, h2 = (h >> 32) | 1;
+		for (int i = 0; i < k; ++i) {
+			uint64_t b = (h1 + i * h2) % nbits;
+			if (!(words[b >> 6] & (1ULL << (b & 63))))
+				return false;//һλΪ0һ
+		}
+		return true;//ܴڣʣ
 	}
 	// bool operator<(const BloomFilter& b) const{
 	// 	return this->vec.size() > b.vec.size();
@@ -20,7 +42,38 @@ public:
 	int remain_capacity() {
 		return capacity;//ز¡ǰʣӶٸԪ
 	}
+	//λıʣ
+	void clear() {
+		std::fill(words.begin(), words.end(), 0);
+	}
+	//գλԭ棬ʱҪλ͹ϣһ
+	void save(snapshot_writer& w) const {
+		w.put<uint64_t>(nbits);
+		w.put<int32_t>(k);
+		w.put<uint32_t>(capacity);
+		w.put_vector(words);
+	}
+	bool load(snapshot_reader& r) {
+		uint64_t bits = 0;
+		int32_t hashes = 0;
+		uint32_t remain = 0;
+		std::vector<uint64_t> w;
+		if (!r.get(bits) || !r.get(hashes) || !r.get(remain) || !r.get_vector(w) ||
+			bits != nbits || hashes != k || w.size() != words.size())
+			return false;
+		words.swap(w);
+		capacity = remain;
+		return true;
+	}
 private:
-	std::set<int> s;//ڴ洢ӵеԪ
+	static uint64_t hash(unsigned int count) {
+		uint64_t x = count + 0x9e3779b97f4a7c15ULL;//splitmix64
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+	std::vector<uint64_t> words;//λ
+	uint64_t nbits;//λ鳤
+	int k;//ϣ
 	unsigned int capacity;//¼ʣ
 };
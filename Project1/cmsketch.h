@@ -0,0 +1,75 @@
+#pragma once
+// 固定内存的近似频率引擎：count-min sketch（保守更新 + 指数老化）
+// 计数器按行连续存放在一个数组中，更新/老化都是对齐的平铺循环，便于编译器向量化
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class CountMinSketch {
+public:
+    // width 向上取整为 2 的幂，depth 行共用一块连续内存
+    explicit CountMinSketch(int width, int depth = 4) :
+        _depth(depth < 1 ? 1 : (depth > kMaxDepth ? kMaxDepth : depth)) {
+        size_t w = 64;
+        while (w < static_cast<size_t>(std::max(1, width)))
+            w <<= 1;
+        _width = w;
+        _mask = w - 1;
+        _counters.assign(_width * _depth, 0);
+    }
+
+    // 保守更新：只把低于 (最小值 + weight) 的计数器抬到该值
+    void add(int key, uint32_t weight = 1) {
+        size_t idx[kMaxDepth];
+        uint32_t est = UINT32_MAX;
+        for (int i = 0; i < _depth; ++i) {
+            idx[i] = i * _width + index_of(key, i);
+            est = std::min(est, _counters[idx[i]]);
+        }
+        uint32_t target = est > UINT32_MAX - weight ? UINT32_MAX : est + weight;
+        for (int i = 0; i < _depth; ++i) {
+            _counters[idx[i]] = std::max(_counters[idx[i]], target);
+        }
+    }
+
+    uint32_t estimate(int key) const {
+        uint32_t est = UINT32_MAX;
+        for (int i = 0; i < _depth; ++i) {
+            est = std::min(est, _counters[i * _width + index_of(key, i)]);
+        }
+        return est;
+    }
+
+    // 指数老化：所有计数器右移 shift 位（默认减半）
+    void age(int shift = 1) {
+        uint32_t* c = _counters.data();
+        const size_t n = _counters.size();
+        for (size_t i = 0; i < n; ++i) {
+            c[i] >>= shift;
+        }
+    }
+
+    void clear() {
+        std::fill(_counters.begin(), _counters.end(), 0);
+    }
+
+    size_t memory_bytes() const {
+        return _counters.size() * sizeof(uint32_t);
+    }
+
+    static const int kMaxDepth = 8;
+
+private:
+    size_t index_of(int key, int row) const {
+        uint64_t x = (static_cast<uint32_t>(key) + 0x9e3779b97f4a7c15ULL * (row + 1)) * 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 31;
+        x *= 0x94d049bb133111ebULL;
+        return static_cast<size_t>(x >> 32) & _mask;
+    }
+
+    std::vector<uint32_t> _counters;
+    size_t _width;
+    size_t _mask;
+    int _depth;
+};
@@ -0,0 +1,403 @@
+#include "csv_trace.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+const size_t kReadBytes = 1 << 20;
+const size_t kPadding = 8;  // 按 8 字节读取时可能越过有效数据末尾
+const int kBlockShift = 12;  // 4KB 块
+const uint64_t kFiletimeToUnix = 11644473600ULL;  // 1601-01-01 到 1970-01-01 的秒数
+
+inline uint64_t load_word(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 8 个 ASCII 数字一次换算（SWAR）：先校验每个字节都在 '0'..'9'，再两两、四四、八八合并
+inline bool parse_8_digits(const char* p, uint64_t* v) {
+    uint64_t w = load_word(p);
+    if ((w & 0xf0f0f0f0f0f0f0f0ULL) != 0x3030303030303030ULL ||
+        ((w + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) != 0x3030303030303030ULL) {
+        return false;
+    }
+    w -= 0x3030303030303030ULL;
+    w = (w * 10 + (w >> 8)) & 0x00ff00ff00ff00ffULL;
+    w = (w * 100 + (w >> 16)) & 0x0000ffff0000ffffULL;
+    w = (w * 10000 + (w >> 32)) & 0x00000000ffffffffULL;
+    *v = w;
+    return true;
+}
+
+bool parse_u64(const csv_field& f, uint64_t* v) {
+    if (f.n == 0 || f.n > 20) {
+        return false;
+    }
+    uint64_t r = 0;
+    size_t i = 0;
+    for (uint64_t d8; i + 8 <= f.n; i += 8) {
+        if (!parse_8_digits(f.p + i, &d8)) {
+            return false;
+        }
+        r = r * 100000000 + d8;
+    }
+    for (; i < f.n; ++i) {
+        unsigned d = static_cast<unsigned char>(f.p[i]) - '0';
+        if (d > 9) {
+            return false;
+        }
+        r = r * 10 + d;
+    }
+    *v = r;
+    return true;
+}
+
+bool equals(const csv_field& f, const char* s) {
+    size_t n = std::strlen(s);
+    if (f.n != n) {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        char c = f.p[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != s[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool starts_with(const csv_field& f, const char* s) {
+    size_t n = std::strlen(s);
+    return f.n >= n && equals(csv_field{ f.p, n }, s);
+}
+
+// memcached 风格的操作名（Twitter 与 Meta 的 trace 都用这一套）
+int kv_op(const csv_field& f) {
+    if (starts_with(f, "get")) {
+        return OP_READ;
+    }
+    if (equals(f, "delete")) {
+        return OP_DELETE;
+    }
+    static const char* const writes[] = { "set", "add", "replace", "cas", "append", "prepend", "incr", "decr" };
+    for (const char* w : writes) {
+        if (equals(f, w)) {
+            return OP_WRITE;
+        }
+    }
+    return OP_OTHER;
+}
+
+int blocks_of(uint64_t bytes) {
+    uint64_t n = (bytes + (1u << kBlockShift) - 1) >> kBlockShift;
+    return n < 1 ? 1 : static_cast<int>(std::min<uint64_t>(n, INT_MAX));
+}
+
+// 逗号所在字节的最高位置 1；用 (x & 0x7f) + 0x7f 判零，不会因借位产生误报
+inline uint64_t comma_mask(uint64_t word) {
+    const uint64_t low7 = 0x7f7f7f7f7f7f7f7fULL;
+    uint64_t x = word ^ 0x2c2c2c2c2c2c2c2cULL;
+    return ~(((x & low7) + low7) | x | low7);
+}
+
+inline unsigned lowest_bit(uint64_t v) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return static_cast<unsigned>(i);
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if (_BitScanForward(&i, static_cast<unsigned long>(v))) {
+        return static_cast<unsigned>(i);
+    }
+    _BitScanForward(&i, static_cast<unsigned long>(v >> 32));
+    return static_cast<unsigned>(i) + 32;
+#else
+    return static_cast<unsigned>(__builtin_ctzll(v));
+#endif
+}
+
+} // namespace
+
+bool CsvReader::open(const char* path) {
+    if (fopen_s(&_file, path, "rb") != 0 || !_file) {
+        _file = nullptr;
+        return false;
+    }
+    _buf.resize(kReadBytes + kPadding);
+    return true;
+}
+
+// 把未处理的部分移到缓冲区开头再读入；一行比缓冲区还长时把缓冲区加倍
+bool CsvReader::refill() {
+    size_t left = _end - _begin;
+    if (_begin > 0) {
+        std::memmove(_buf.data(), _buf.data() + _begin, left);
+    }
+    _begin = 0;
+    _end = left;
+    if (_end + kPadding == _buf.size()) {
+        _buf.resize(_buf.size() * 2);
+    }
+    size_t n = fread(_buf.data() + _end, 1, _buf.size() - kPadding - _end, _file);
+    _end += n;
+    if (n == 0) {
+        _eof = true;
+    }
+    return n > 0;
+}
+
+bool CsvReader::next(std::vector<csv_field>& fields) {
+    while (true) {
+        const char* data = _buf.data();
+        const char* line = data + _begin;
+        const char* end = data + _end;
+        const char* nl = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!nl) {
+            if (!_eof) {
+                refill();
+                continue;
+            }
+            if (line == end) {
+                return false;
+            }
+            nl = end;  // 最后一行没有换行符
+        }
+        _begin = nl == end ? _end : static_cast<size_t>(nl - data) + 1;
+        const char* stop = nl > line && nl[-1] == '\r' ? nl - 1 : nl;
+        if (stop == line) {
+            continue;  // 空行
+        }
+        // 行内按 8 字节一组找逗号；缓冲区尾部留有 kPadding 字节，越过行尾的位被截掉
+        fields.clear();
+        const char* field = line;
+        for (const char* p = line; p < stop; p += 8) {
+            uint64_t mask = comma_mask(load_word(p));
+            if (stop - p < 8) {
+                mask &= (1ULL << ((stop - p) * 8)) - 1;
+            }
+            while (mask) {
+                const char* q = p + (lowest_bit(mask) >> 3);
+                mask &= mask - 1;
+                fields.push_back(csv_field{ field, static_cast<size_t>(q - field) });
+                field = q + 1;
+            }
+        }
+        fields.push_back(csv_field{ field, static_cast<size_t>(stop - field) });
+        return true;
+    }
+}
+
+bool CsvTraceSource::open(const char* path) {
+    _path = path;
+    return _reader.open(path);
+}
+
+bool CsvTraceSource::next(trace_line& l) {
+    while (_reader.next(_fields)) {
+        ++_line;
+        if (!parse(_fields, l)) {
+            ++_bad_lines;
+            continue;
+        }
+        if (!is_access_op(l.ignore)) {
+            ++_skipped_ops;
+            continue;
+        }
+        l.access_count = 0;
+        return true;
+    }
+    // 读到文件尾时报告一次跳过的行数
+    if (_bad_lines > 0 && !_quiet) {
+        std::cerr << format() << ": skipped " << _bad_lines << " malformed lines" << std::endl;
+    }
+    if (_skipped_ops > 0 && !_quiet) {
+        std::cerr << format() << ": skipped " << _skipped_ops << " delete/other operations" << std::endl;
+    }
+    _bad_lines = 0;
+    _skipped_ops = 0;
+    return false;
+}
+
+bool MsrTraceSource::parse(const std::vector<csv_field>& fields, trace_line& l) {
+    uint64_t timestamp, offset, size;
+    if (fields.size() < 6 || !parse_u64(fields[0], &timestamp) ||
+        !parse_u64(fields[4], &offset) || !parse_u64(fields[5], &size)) {
+        return false;
+    }
+    uint64_t first = offset >> kBlockShift;
+    uint64_t last = size > 0 ? (offset + size - 1) >> kBlockShift : first;
+    if (last > static_cast<uint64_t>(INT_MAX)) {
+        return false;
+    }
+    l.starting_block = static_cast<int>(first);
+    l.size_of_blocks = static_cast<int>(last - first + 1);
+    l.ignore = equals(fields[3], "write") ? OP_WRITE : OP_READ;
+    l.request_number = static_cast<int>(_line);
+    // Windows FILETIME（100ns，从 1601 年起）换算为 Unix 秒
+    l.current_time = static_cast<time_t>(timestamp / 10000000 - kFiletimeToUnix);
+    return true;
+}
+
+// FNV-1a 哈希后按首次出现的顺序分配块区间，模拟器访问 [base, base + blocks)，各 key 的区间不重叠
+int KvTraceSource::block_of(const csv_field& key, uint64_t bytes, int* blocks) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < key.n; ++i) {
+        h = (h ^ static_cast<unsigned char>(key.p[i])) * 1099511628211ULL;
+    }
+    int need = blocks_of(bytes);
+    auto it = _ids.emplace(h, key_range{ -1, 0 }).first;
+    key_range& r = it->second;
+    if (need > r.blocks) {
+        if (_next_block + need > INT_MAX) {
+            return -1;
+        }
+        r.base = static_cast<int>(_next_block);
+        r.blocks = need;
+        _next_block += need;
+    }
+    *blocks = need;
+    return r.base;
+}
+
+bool TwitterTraceSource::parse(const std::vector<csv_field>& fields, trace_line& l) {
+    uint64_t timestamp, key_size, value_size;
+    if (fields.size() < 6 || !parse_u64(fields[0], &timestamp) ||
+        !parse_u64(fields[2], &key_size) || !parse_u64(fields[3], &value_size)) {
+        return false;
+    }
+    l.ignore = kv_op(fields[5]);
+    if (!is_access_op(l.ignore)) {
+        return true;  // 由 next() 跳过，不为 key 保留块
+    }
+    l.starting_block = block_of(fields[1], key_size + value_size, &l.size_of_blocks);
+    if (l.starting_block < 0) {
+        return false;
+    }
+    l.request_number = static_cast<int>(_line);
+    l.current_time = static_cast<time_t>(timestamp);
+    return true;
+}
+
+bool MetaKvTraceSource::read_header() {
+    if (!_reader.next(_fields)) {
+        return false;
+    }
+    ++_line;
+    static const char* const names[COL_NUM][2] = {
+        { "key", "key" }, { "op", "op" }, { "size", "value_size" },
+        { "key_size", "key_size" }, { "op_time", "timestamp" }, { "op_count", "op_count" },
+    };
+    for (int c = 0; c < COL_NUM; ++c) {
+        _columns[c] = -1;
+        for (size_t k = 0; k < _fields.size(); ++k) {
+            if (equals(_fields[k], names[c][0]) || equals(_fields[k], names[c][1])) {
+                _columns[c] = static_cast<int>(k);
+                break;
+            }
+        }
+    }
+    _has_header = true;
+    if (_columns[COL_KEY] < 0) {
+        std::cerr << "meta: header has no 'key' column" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MetaKvTraceSource::next(trace_line& l) {
+    if (_repeat > 0) {
+        --_repeat;
+        l = _pending;
+        return true;
+    }
+    if (!_has_header && !read_header()) {
+        return false;
+    }
+    if (!CsvTraceSource::next(l)) {
+        return false;
+    }
+    if (_repeat > 0) {
+        _pending = l;
+    }
+    return true;
+}
+
+bool MetaKvTraceSource::parse(const std::vector<csv_field>& fields, trace_line& l) {
+    if (_columns[COL_KEY] < 0 || static_cast<size_t>(_columns[COL_KEY]) >= fields.size()) {
+        return false;
+    }
+    // 可选的数值列：不存在时取默认值，存在但不是数字时整行作废
+    uint64_t values[COL_NUM] = { 0, 0, 0, 0, 0, 1 };
+    for (int c = COL_SIZE; c < COL_NUM; ++c) {
+        int k = _columns[c];
+        if (k >= 0 && (static_cast<size_t>(k) >= fields.size() || !parse_u64(fields[k], &values[c]))) {
+            return false;
+        }
+    }
+    int op = _columns[COL_OP];
+    l.ignore = op >= 0 && static_cast<size_t>(op) < fields.size() ? kv_op(fields[op]) : OP_READ;
+    _repeat = 0;
+    if (!is_access_op(l.ignore)) {
+        return true;  // 由 next() 跳过，不展开 op_count
+    }
+    l.starting_block = block_of(fields[_columns[COL_KEY]], values[COL_SIZE] + values[COL_KEY_SIZE], &l.size_of_blocks);
+    if (l.starting_block < 0) {
+        return false;
+    }
+    l.request_number = static_cast<int>(_line);
+    l.current_time = static_cast<time_t>(values[COL_TIME]);
+    _repeat = values[COL_COUNT] > 1 ? values[COL_COUNT] - 1 : 0;
+    return true;
+}
+
+namespace {
+
+CsvTraceSource* new_csv_source(const std::string& prefix) {
+    if (prefix == "msr") {
+        return new MsrTraceSource();
+    }
+    if (prefix == "twitter") {
+        return new TwitterTraceSource();
+    }
+    if (prefix == "meta") {
+        return new MetaKvTraceSource();
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// 只在按比例设置预热长度时调用一次，多解析一遍换取与 next() 完全一致的条数
+uint64_t CsvTraceSource::length() {
+    std::unique_ptr<CsvTraceSource> copy(new_csv_source(format()));
+    if (!copy || !copy->open(_path.c_str())) {
+        return 0;
+    }
+    copy->_quiet = true;
+    trace_line l;
+    uint64_t n = 0;
+    while (copy->next(l)) {
+        ++n;
+    }
+    return n;
+}
+
+std::unique_ptr<TraceSource> open_csv_trace(const std::string& name, bool* matched) {
+    size_t colon = name.find(':');
+    std::unique_ptr<CsvTraceSource> source(new_csv_source(colon == std::string::npos ? "" : name.substr(0, colon)));
+    *matched = static_cast<bool>(source);
+    if (!source || !source->open(name.c_str() + colon + 1)) {
+        return nullptr;
+    }
+    return source;
+}
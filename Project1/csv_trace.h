@@ -0,0 +1,139 @@
+#pragma once
+// 公开 trace 格式的解析：按格式把每条记录映射为 trace_line
+//   msr:<文件>      MSR Cambridge / SNIA 块 trace：Timestamp,Hostname,DiskNumber,Type,Offset,Size,ResponseTime
+//   twitter:<文件>  Twitter 缓存 trace：timestamp,key,key_size,value_size,client_id,operation,ttl
+//   meta:<文件>     Meta/CacheLib KV trace：首行为列名，按列名取 key、op、size、key_size、op_time、op_count
+// 块 trace 按 4KB 块把 [offset, offset+size) 换算为块区间；KV trace 按对象大小（4KB 向上取整）
+// 为每个 key 保留一段互不重叠的块区间。ignore 字段记录操作类型（见 trace_op），
+// 模拟器只把读写当作访问，DELETE 与无法识别的操作在读取时跳过
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "trace_source.h"
+
+// 写入 trace_line::ignore 的操作类型
+enum trace_op {
+    OP_READ = 0,   // 块读 / KV get
+    OP_WRITE = 1,  // 块写 / KV set、add、replace 等
+    OP_DELETE = 2,
+    OP_OTHER = 3,
+};
+
+inline bool is_access_op(int op) {
+    return op == OP_READ || op == OP_WRITE;
+}
+
+struct csv_field {
+    const char* p;
+    size_t n;
+};
+
+/**
+ * 按块读取的 CSV 分词器：每次读入 1MB，按 8 字节一组（SWAR）同时定位逗号和换行，
+ * 每找到一个分隔符只做一次位运算，没有逐字节的分支。字段直接指向缓冲区，不复制、不分配。
+ * 不支持带引号的字段（上述格式都不需要）
+ */
+class CsvReader {
+public:
+    CsvReader() : _file(nullptr), _begin(0), _end(0), _eof(false) {}
+    ~CsvReader() {
+        if (_file) {
+            fclose(_file);
+        }
+    }
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    bool open(const char* path);
+    // 读取下一行并按逗号切分，文件结束返回 false；字段在下一次调用前有效，空行会被跳过
+    bool next(std::vector<csv_field>& fields);
+
+private:
+    bool refill();
+
+    FILE* _file;
+    std::vector<char> _buf;
+    size_t _begin;
+    size_t _end;
+    bool _eof;
+};
+
+// 各格式共用：逐行读取，解析失败的行和非读写操作跳过，并在结束时报告条数
+class CsvTraceSource : public TraceSource {
+public:
+    CsvTraceSource() : _bad_lines(0), _skipped_ops(0), _line(0), _quiet(false) {}
+
+    bool open(const char* path);
+    bool next(trace_line& l) override;
+    // 实际产出的记录数（跳过的行、op_count 展开都已计入）：另开一个同格式的来源完整解析一遍
+    uint64_t length() override;
+
+protected:
+    // 把一行映射为 trace_line，格式不对返回 false
+    virtual bool parse(const std::vector<csv_field>& fields, trace_line& l) = 0;
+    virtual const char* format() const = 0;
+
+    CsvReader _reader;
+    std::vector<csv_field> _fields;
+    std::string _path;
+    uint64_t _bad_lines;
+    uint64_t _skipped_ops;  // DELETE 等非读写操作
+    uint64_t _line;  // 已读取的行号（从 1 开始），记为 request_number
+    bool _quiet;     // 不报告跳过的行（length() 计数时用）
+};
+
+class MsrTraceSource : public CsvTraceSource {
+protected:
+    bool parse(const std::vector<csv_field>& fields, trace_line& l) override;
+    const char* format() const override { return "msr"; }
+};
+
+// KV trace 的公共部分：key 到块区间的映射
+class KvTraceSource : public CsvTraceSource {
+public:
+    KvTraceSource() : _next_block(0) {}
+
+protected:
+    // 第一次见到 key 时从 _next_block 起按对象大小保留一段块区间，之后对象变大时改到一段新的更大区间。
+    // 返回区间起点，*blocks 为本次访问的块数；块号超出 int 范围时返回 -1
+    int block_of(const csv_field& key, uint64_t bytes, int* blocks);
+
+    struct key_range {
+        int base;
+        int blocks;  // 已保留的块数
+    };
+    std::unordered_map<uint64_t, key_range> _ids;  // key 的 64 位哈希 -> 块区间
+    int64_t _next_block;
+};
+
+class TwitterTraceSource : public KvTraceSource {
+protected:
+    bool parse(const std::vector<csv_field>& fields, trace_line& l) override;
+    const char* format() const override { return "twitter"; }
+};
+
+// op_count > 1 的记录展开为多次访问
+class MetaKvTraceSource : public KvTraceSource {
+public:
+    MetaKvTraceSource() : _repeat(0), _has_header(false) {}
+    bool next(trace_line& l) override;
+
+protected:
+    bool parse(const std::vector<csv_field>& fields, trace_line& l) override;
+    const char* format() const override { return "meta"; }
+
+private:
+    enum { COL_KEY, COL_OP, COL_SIZE, COL_KEY_SIZE, COL_TIME, COL_COUNT, COL_NUM };
+    bool read_header();
+
+    int _columns[COL_NUM];  // 各列的位置，-1 表示不存在
+    trace_line _pending;
+    uint64_t _repeat;       // _pending 还要重复的次数
+    bool _has_header;
+};
+
+// 按前缀（msr: / twitter: / meta:）打开公开格式的 trace；不是这些前缀时返回 nullptr 且 *matched 为 false
+std::unique_ptr<TraceSource> open_csv_trace(const std::string& name, bool* matched);
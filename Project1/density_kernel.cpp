@@ -0,0 +1,161 @@
+#include "density_kernel.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define DENSITY_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DENSITY_TARGET_AVX2
+#else
+#define DENSITY_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+#endif
+
+namespace {
+
+const size_t kLanes = 8;
+
+// 第一遍的标量部分：从 first 开始，按 i % 8 累加到对应的分组
+size_t density_tail(const int32_t* temp, const int32_t* size, const int32_t* age, int32_t min_age,
+    size_t first, size_t n, float* density, float* lanes) {
+    size_t valid = 0;
+    for (size_t i = first; i < n; ++i) {
+        float prod = static_cast<float>(size[i]) * static_cast<float>(age[i]);
+        if (age[i] >= min_age && prod > 0) {
+            density[i] = static_cast<float>(temp[i]) / prod;
+            lanes[i % kLanes] += density[i];
+            ++valid;
+        }
+        else {
+            density[i] = -1;
+        }
+    }
+    return valid;
+}
+
+size_t select_tail(const float* density, float average, size_t first, size_t n, uint8_t* mask) {
+    size_t selected = 0;
+    for (size_t i = first; i < n; ++i) {
+        mask[i] = density[i] >= 0 && density[i] <= average;
+        selected += mask[i];
+    }
+    return selected;
+}
+
+float lane_sum(const float* lanes) {
+    float sum = 0;
+    for (size_t k = 0; k < kLanes; ++k) {
+        sum += lanes[k];
+    }
+    return sum;
+}
+
+density_summary score_scalar(const int32_t* temp, const int32_t* size, const int32_t* age, int32_t min_age,
+    size_t n, float* density, uint8_t* mask) {
+    float lanes[kLanes] = {};
+    density_summary r;
+    r.valid = density_tail(temp, size, age, min_age, 0, n, density, lanes);
+    r.average = r.valid ? lane_sum(lanes) / r.valid : 0;
+    r.selected = select_tail(density, r.average, 0, n, mask);
+    return r;
+}
+
+#ifdef DENSITY_X86
+
+DENSITY_TARGET_AVX2
+density_summary score_avx2(const int32_t* temp, const int32_t* size, const int32_t* age, int32_t min_age,
+    size_t n, float* density, uint8_t* mask) {
+    size_t body = n - n % kLanes;
+    const __m256i min_v = _mm256_set1_epi32(min_age);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 invalid = _mm256_set1_ps(-1);
+    __m256 sum = zero;
+    size_t valid = 0;
+    for (size_t i = 0; i < body; i += kLanes) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(age + i));
+        __m256 t = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(temp + i)));
+        __m256 s = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(size + i)));
+        __m256 prod = _mm256_mul_ps(s, _mm256_cvtepi32_ps(a));
+        // age >= min_age 即 !(min_age > age)
+        __m256 young = _mm256_castsi256_ps(_mm256_cmpgt_epi32(min_v, a));
+        __m256 ok = _mm256_andnot_ps(young, _mm256_cmp_ps(prod, zero, _CMP_GT_OQ));
+        __m256 d = _mm256_div_ps(t, prod);
+        _mm256_storeu_ps(density + i, _mm256_blendv_ps(invalid, d, ok));
+        sum = _mm256_add_ps(sum, _mm256_and_ps(d, ok));
+        valid += static_cast<size_t>(_mm_popcnt_u32(static_cast<unsigned>(_mm256_movemask_ps(ok))));
+    }
+    float lanes[kLanes];
+    _mm256_storeu_ps(lanes, sum);
+    density_summary r;
+    r.valid = valid + density_tail(temp, size, age, min_age, body, n, density, lanes);
+    r.average = r.valid ? lane_sum(lanes) / r.valid : 0;
+
+    const __m256 avg = _mm256_set1_ps(r.average);
+    size_t selected = 0;
+    for (size_t i = 0; i < body; i += kLanes) {
+        __m256 d = _mm256_loadu_ps(density + i);
+        __m256 pick = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_GE_OQ), _mm256_cmp_ps(d, avg, _CMP_LE_OQ));
+        // 8 个 32 位比较结果依次压缩成 8 个字节（0 或 1）
+        __m256i p = _mm256_castps_si256(pick);
+        __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+        __m128i b = _mm_and_si128(_mm_packs_epi16(w, w), _mm_set1_epi8(1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(mask + i), b);
+        selected += static_cast<size_t>(_mm_popcnt_u32(static_cast<unsigned>(_mm256_movemask_ps(pick))));
+    }
+    r.selected = selected + select_tail(density, r.average, body, n, mask);
+    return r;
+}
+
+bool cpu_has_avx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // 需要 POPCNT、OSXSAVE、AVX，且操作系统保存了 YMM 寄存器
+    if ((info[2] & (1 << 23)) == 0 || (info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 ||
+        (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+}
+
+#endif
+
+bool g_force_scalar = false;
+
+bool use_avx2() {
+#ifdef DENSITY_X86
+    static const bool supported = cpu_has_avx2();
+    return supported && !g_force_scalar;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+density_summary score_density(const int32_t* temp, const int32_t* size, const int32_t* age, int32_t min_age,
+    size_t n, float* density, uint8_t* mask) {
+#ifdef DENSITY_X86
+    if (use_avx2()) {
+        return score_avx2(temp, size, age, min_age, n, density, mask);
+    }
+#endif
+    return score_scalar(temp, size, age, min_age, n, density, mask);
+}
+
+const char* density_kernel_name() {
+    return use_avx2() ? "avx2" : "scalar";
+}
+
+void force_scalar_density_kernel(bool scalar) {
+    g_force_scalar = scalar;
+}
@@ -0,0 +1,24 @@
+#pragma once
+// tdcCache 淘汰候选的密度打分核：对按列存放的一批候选计算
+//   density[i] = temp[i] / (size[i] × age[i])
+// age < min_age 或 size × age 不为正的候选无效（density 记为 -1），其余求平均，
+// mask[i] = 1 表示有效且密度不高于平均值，即应被淘汰。
+// x86-64 上运行时检测 AVX2，每次处理 8 个候选；否则用标量实现。
+// 两种实现按同样的 8 路分组累加，浮点运算顺序一致，结果逐位相同
+
+#include <cstddef>
+#include <cstdint>
+
+struct density_summary {
+    float average;   // 有效候选的平均密度，没有有效候选时为 0
+    size_t valid;    // 有效候选数
+    size_t selected; // mask 为 1 的候选数
+};
+
+density_summary score_density(const int32_t* temp, const int32_t* size, const int32_t* age, int32_t min_age,
+    size_t n, float* density, uint8_t* mask);
+
+// 当前使用的实现："avx2" 或 "scalar"
+const char* density_kernel_name();
+// 强制使用标量实现（对比测试用）；false 时恢复按 CPU 选择
+void force_scalar_density_kernel(bool scalar);
@@ -0,0 +1,21 @@
+#pragma once
+// 64 位文件偏移（trace 文件、检查点可能超过 2GB，Windows 上 long 只有 32 位）
+
+#include <cstdint>
+#include <cstdio>
+
+inline int file_seek64(FILE* f, uint64_t offset, int origin = SEEK_SET) {
+#ifdef _MSC_VER
+    return _fseeki64(f, static_cast<int64_t>(offset), origin);
+#else
+    return fseeko(f, static_cast<off_t>(offset), origin);
+#endif
+}
+
+inline uint64_t file_tell64(FILE* f) {
+#ifdef _MSC_VER
+    return static_cast<uint64_t>(_ftelli64(f));
+#else
+    return static_cast<uint64_t>(ftello(f));
+#endif
+}
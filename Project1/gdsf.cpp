@@ -0,0 +1,129 @@
+#include "gdsf.h"
+#include <algorithm>
+#include <sstream>
+
+bool GDSFCache::get(int target, double request_bytes) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    ++_get_count;
+    auto it = _pos.find(target);
+    if (it != _pos.end()) {
+        ++_hit_count;
+        size_t i = it->second;
+        entry& e = _heap[i];
+        ++e.frequency;
+        e.priority = _clock + e.frequency * e.unit_cost;
+        sift_down(i);  // 优先级只增不减
+        return true;
+    }
+
+    if (_heap.size() >= static_cast<size_t>(_capacity)) {
+        _clock = _heap[0].priority;
+        if (_eviction_log) {
+            _eviction_log->push_back(_heap[0].target);
+        }
+        remove_at(0);
+        ++_eviction_count;
+    }
+    entry e;
+    e.unit_cost = _cost.block_cost_us(request_bytes);
+    e.frequency = 1;
+    e.priority = _clock + e.unit_cost;
+    e.target = target;
+    _heap.push_back(e);
+    _pos[target] = _heap.size() - 1;
+    sift_up(_heap.size() - 1);
+    return false;
+}
+
+int GDSFCache::victim() const {
+    if (_heap.empty() || _heap.size() < static_cast<size_t>(_capacity)) {
+        return -1;
+    }
+    return _heap[0].target;
+}
+
+void GDSFCache::residents(std::vector<int>& out) const {
+    std::vector<std::pair<double, int>> order;
+    order.reserve(_heap.size());
+    for (const entry& e : _heap) {
+        order.emplace_back(e.priority, e.target);
+    }
+    std::sort(order.begin(), order.end());
+    for (const auto& o : order) {
+        out.push_back(o.second);
+    }
+}
+
+bool GDSFCache::erase(int target) {
+    auto it = _pos.find(target);
+    if (it == _pos.end()) {
+        return false;
+    }
+    remove_at(it->second);
+    return true;
+}
+
+void GDSFCache::sift_up(size_t i) {
+    entry e = _heap[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (_heap[parent].priority <= e.priority) {
+            break;
+        }
+        place(i, _heap[parent]);
+        i = parent;
+    }
+    place(i, e);
+}
+
+void GDSFCache::sift_down(size_t i) {
+    entry e = _heap[i];
+    size_t n = _heap.size();
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && _heap[child + 1].priority < _heap[child].priority) {
+            ++child;
+        }
+        if (e.priority <= _heap[child].priority) {
+            break;
+        }
+        place(i, _heap[child]);
+        i = child;
+    }
+    place(i, e);
+}
+
+// 用最后一个元素填补空位，再按它与原位置的大小关系上移或下移
+void GDSFCache::remove_at(size_t i) {
+    _pos.erase(_heap[i].target);
+    entry last = _heap.back();
+    _heap.pop_back();
+    if (i == _heap.size()) {
+        return;
+    }
+    double old = _heap[i].priority;
+    place(i, last);
+    if (last.priority < old) {
+        sift_up(i);
+    }
+    else {
+        sift_down(i);
+    }
+}
+
+std::string GDSFCache::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << " gdsf_cache:"
+        << " cache_size:" << _capacity
+        << " request:" << _get_count
+        << " hit:" << _hit_count
+        << " miss:" << _get_count - _hit_count
+        << " hit_rate:" << (_get_count ? 1.0 * _hit_count / _get_count : 0.0)
+        << " clock:" << _clock << std::endl;
+    return s.str();
+}
@@ -0,0 +1,65 @@
+#pragma once
+// GreedyDual-Size-Frequency：优先级 H = L + 频率 × 未命中代价 / 大小，淘汰 H 最小的对象，
+// 并把膨胀时钟 L 推进到被淘汰对象的 H，使长期不访问的对象逐渐被新对象超过
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "stats.h"
+
+class GDSFCache {
+public:
+    // c 为容量（对象数，与其他策略一致）；cost 为未命中代价模型
+    explicit GDSFCache(int c, std::string file_name, const miss_cost_model& cost = miss_cost_model()) :
+        _capacity(c), _file_name(file_name), _cost(cost), _clock(0),
+        _hit_count(0), _get_count(0), _eviction_count(0) {}
+
+    GDSFCache(const GDSFCache&) = delete;
+    GDSFCache& operator=(const GDSFCache&) = delete;
+
+    // request_bytes 为该块所属请求的字节数：代价按请求计算后均摊到请求的每个块上，
+    // 所以大请求中的块单位代价低（寻道时间被分摊），小的随机请求优先保留
+    bool get(int target, double request_bytes);
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _heap.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    bool contains(int target) const { return _pos.find(target) != _pos.end(); }
+    // 缓存已满时下一次未命中将淘汰的对象（堆顶），否则 -1
+    int victim() const;
+    bool erase(int target);
+    // 驻留对象按淘汰先后（优先级从低到高）追加到 out
+    void residents(std::vector<int>& out) const;
+    // 非空时把每个被淘汰的对象追加到 log（erase 不算淘汰），多级缓存独占模式按它降级
+    void set_eviction_log(std::vector<int>* log) { _eviction_log = log; }
+
+private:
+    struct entry {
+        double priority;
+        double unit_cost;  // 每块的未命中代价（微秒）
+        uint32_t frequency;
+        int target;
+    };
+
+    // 按优先级的最小堆，_pos 记录每个对象在堆中的下标，命中时原地调整
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+    void place(size_t i, const entry& e) {
+        _heap[i] = e;
+        _pos[e.target] = i;
+    }
+    void remove_at(size_t i);
+
+    int _capacity;
+    std::string _file_name;
+    miss_cost_model _cost;
+    double _clock;  // 膨胀时钟 L
+    std::vector<entry> _heap;
+    std::unordered_map<int, size_t> _pos;
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _eviction_count;
+    std::vector<int>* _eviction_log = nullptr;
+};
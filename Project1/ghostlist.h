@@ -0,0 +1,149 @@
+#pragma once
+// 只保存 32 位指纹的幽灵列表：FIFO 队列 + 指纹计数表
+// 中间删除采用惰性墓碑，出队时跳过；墓碑过多时整体压缩，均摊 O(1)
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "snapshot.h"
+#include "memory_resource.h"
+
+class GhostList {
+public:
+    // 队列和计数表的节点从 resource 分配，nullptr 表示全局 operator new
+    explicit GhostList(memory_resource* resource = nullptr) : _fifo(resource), _index(0, resource), _size(0) {}
+
+    static uint32_t fingerprint(int key) {
+        uint32_t x = static_cast<uint32_t>(key);
+        x = (x ^ (x >> 16)) * 0x7feb352dU;
+        x = (x ^ (x >> 15)) * 0x846ca68bU;
+        return x ^ (x >> 16);
+    }
+
+    // 插入到最新端
+    void push_front(int key) {
+        uint32_t fp = fingerprint(key);
+        _fifo.push_front(fp);
+        ++_index[fp].live;
+        ++_size;
+    }
+
+    bool contains(int key) const {
+        auto it = _index.find(fingerprint(key));
+        return it != _index.end() && it->second.live > 0;
+    }
+
+    // 从列表中间移除（命中幽灵列表时），只记墓碑，不移动队列
+    bool erase(int key) {
+        auto it = _index.find(fingerprint(key));
+        if (it == _index.end() || it->second.live == 0) {
+            return false;
+        }
+        --it->second.live;
+        ++it->second.dead;
+        --_size;
+        if (_fifo.size() > 2 * _size + 64) {
+            compact();
+        }
+        return true;
+    }
+
+    // 淘汰最旧的一个活跃指纹
+    void pop_back() {
+        while (!_fifo.empty()) {
+            uint32_t fp = _fifo.back();
+            _fifo.pop_back();
+            auto it = _index.find(fp);
+            bool tombstone = it->second.dead > 0;
+            if (tombstone) {
+                --it->second.dead;
+            }
+            else {
+                --it->second.live;
+                --_size;
+            }
+            if (it->second.live == 0 && it->second.dead == 0) {
+                _index.erase(it);
+            }
+            if (!tombstone) {
+                return;
+            }
+        }
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    void clear() {
+        _fifo.clear();
+        _index.clear();
+        _size = 0;
+    }
+
+    // 快照只保存活跃指纹（从最新到最旧），墓碑在保存时丢弃
+    void save(snapshot_writer& w) const {
+        std::vector<uint32_t> live;
+        live.reserve(_size);
+        std::unordered_map<uint32_t, uint32_t> skip;
+        for (auto it = _fifo.rbegin(); it != _fifo.rend(); ++it) {
+            uint32_t& skipped = skip[*it];
+            if (skipped < _index.find(*it)->second.dead) {
+                ++skipped;
+                continue;
+            }
+            live.push_back(*it);
+        }
+        w.put_vector(std::vector<uint32_t>(live.rbegin(), live.rend()));
+    }
+
+    bool load(snapshot_reader& r) {
+        std::vector<uint32_t> live;
+        if (!r.get_vector(live)) {
+            return false;
+        }
+        clear();
+        _fifo.assign(live.begin(), live.end());
+        _index.reserve(live.size());
+        for (uint32_t fp : live) {
+            ++_index[fp].live;
+        }
+        _size = live.size();
+        return true;
+    }
+
+private:
+    struct slot {
+        uint32_t live = 0;
+        uint32_t dead = 0;
+    };
+
+    // 从最旧端开始丢弃墓碑，重建队列
+    void compact() {
+        std::unordered_map<uint32_t, uint32_t> skip;
+        std::deque<uint32_t, resource_allocator<uint32_t>> kept(_fifo.get_allocator());
+        for (auto it = _fifo.rbegin(); it != _fifo.rend(); ++it) {
+            auto idx = _index.find(*it);
+            uint32_t& skipped = skip[*it];
+            if (skipped < idx->second.dead) {
+                ++skipped;
+                continue;
+            }
+            kept.push_front(*it);
+        }
+        _fifo.swap(kept);
+        for (auto it = _index.begin(); it != _index.end();) {
+            it->second.dead = 0;
+            if (it->second.live == 0) {
+                it = _index.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    std::deque<uint32_t, resource_allocator<uint32_t>> _fifo;  // front 最新，back 最旧（含墓碑）
+    resource_map<uint32_t, slot> _index;
+    size_t _size;
+};
@@ -0,0 +1,305 @@
+#include "hierarchy.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "sim.h"
+#include "trace_source.h"
+
+namespace {
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        out.push_back(item);
+    }
+    return out;
+}
+
+} // namespace
+
+TierHierarchy::TierHierarchy(const std::vector<tier_config>& tiers, const tier_config& backing, bool exclusive,
+    const std::string& trace_name) :
+    _config(tiers), _backing(backing), _exclusive(exclusive), _trace_name(trace_name), _records(false),
+    _block_count(0), _lookups(tiers.size()), _hits(tiers.size()), _demotions(tiers.size()),
+    _line_bytes(tiers.size() + 1), _requests(0), _blocks(0), _backing_blocks(0), _latency_sum_us(0) {}
+
+bool TierHierarchy::init(std::string* error) {
+    for (const auto& t : _config) {
+        std::unique_ptr<CachePolicy> p = make_policy(t.policy, t.capacity, _trace_name, t.allocator);
+        if (!p) {
+            *error = "unknown policy: " + t.policy;
+            return false;
+        }
+        if (_exclusive && !p->supports_exclusive()) {
+            *error = t.policy + " can't be used in an exclusive hierarchy (needs contains/erase)";
+            return false;
+        }
+        _records = _records || p->uses_trace_records();
+        _tiers.push_back(std::move(p));
+    }
+    if (_exclusive) {
+        _evicted.resize(_tiers.size());
+        for (size_t k = 0; k < _tiers.size(); ++k) {
+            _tiers[k]->set_eviction_log(&_evicted[k]);
+        }
+    }
+    return true;
+}
+
+size_t TierHierarchy::lookup_inclusive(int block) {
+    for (size_t k = 0; k < _tiers.size(); ++k) {
+        ++_lookups[k];
+        if (_tiers[k]->get(block, _ctx)) {
+            ++_hits[k];
+            return k;
+        }
+    }
+    return _tiers.size();
+}
+
+size_t TierHierarchy::lookup_exclusive(int block) {
+    size_t level = _tiers.size();
+    for (size_t k = 0; k < _tiers.size(); ++k) {
+        ++_lookups[k];
+        if (_tiers[k]->contains(block)) {
+            ++_hits[k];
+            level = k;
+            break;
+        }
+    }
+    if (level == 0) {
+        _tiers[0]->get(block, _ctx);
+        return 0;
+    }
+    if (level < _tiers.size()) {
+        _tiers[level]->erase(block);
+    }
+    admit(0, block);
+    return level;
+}
+
+// 降级的是 get() 实际淘汰的对象：ARC 的幽灵命中会在淘汰前调整 p，事先用 victim() 预测并不可靠
+void TierHierarchy::admit(size_t k, int block) {
+    std::vector<int>& evicted = _evicted[k];
+    evicted.clear();
+    _tiers[k]->get(block, _ctx);
+    if (k + 1 == _tiers.size()) {
+        return;
+    }
+    // 下一级只会清空自己的记录，这里按下标遍历即可
+    for (size_t i = 0; i < evicted.size(); ++i) {
+        ++_demotions[k];
+        admit(k + 1, evicted[i]);
+    }
+}
+
+double TierHierarchy::service_us(const tier_config& t, double bytes) {
+    // 1 MB/s 即每微秒 1 字节
+    return t.hit_us + (t.bandwidth_mb > 0 ? bytes / t.bandwidth_mb : 0.0);
+}
+
+void TierHierarchy::access_line(const trace_line& l) {
+    std::fill(_line_bytes.begin(), _line_bytes.end(), 0.0);
+    size_t deepest = 0;
+    for_each_block(l, _ctx, _block_count, _records, [&](int i) {
+        size_t level = _exclusive ? lookup_exclusive(i) : lookup_inclusive(i);
+        _line_bytes[level] += kBlockBytes;
+        deepest = std::max(deepest, level);
+    });
+
+    double us = 0;
+    for (size_t k = 0; k < deepest; ++k) {
+        us += _line_bytes[k] > 0 ? service_us(_config[k], _line_bytes[k]) : _config[k].miss_us;
+    }
+    const tier_config& last = deepest < _config.size() ? _config[deepest] : _backing;
+    us += service_us(last, _line_bytes[deepest]);
+
+    ++_requests;
+    _blocks += l.size_of_blocks;
+    _backing_blocks += static_cast<uint64_t>(_line_bytes[_tiers.size()] / kBlockBytes);
+    _latency_sum_us += us;
+    _latency_ns.add(static_cast<uint64_t>(us * 1000.0 + 0.5));
+}
+
+void TierHierarchy::reset_stats() {
+    for (auto& p : _tiers) {
+        p->reset_stats();
+    }
+    std::fill(_lookups.begin(), _lookups.end(), 0);
+    std::fill(_hits.begin(), _hits.end(), 0);
+    std::fill(_demotions.begin(), _demotions.end(), 0);
+    _requests = _blocks = _backing_blocks = 0;
+    _latency_ns.clear();
+    _latency_sum_us = 0;
+}
+
+std::string TierHierarchy::statics() const {
+    std::stringstream s;
+    s << "hierarchy(" << (_exclusive ? "exclusive" : "inclusive") << ") trace:" << _trace_name
+        << " request:" << _requests << " blocks:" << _blocks << std::endl;
+    for (size_t k = 0; k < _tiers.size(); ++k) {
+        cache_stats st = _tiers[k]->stats();
+        s << "tier" << k << " " << _config[k].policy << ":"
+            << " cache_size:" << _config[k].capacity
+            << " lookup:" << _lookups[k]
+            << " hit:" << _hits[k]
+            << " local_hit_rate:" << (_lookups[k] ? 1.0 * _hits[k] / _lookups[k] : 0.0)
+            << " global_hit_rate:" << (_blocks ? 1.0 * _hits[k] / _blocks : 0.0)
+            << " resident:" << st.resident
+            << " alloc:" << policy_allocator_name(_config[k].allocator)
+            << " metadata_bytes:" << st.metadata_bytes;
+        if (_exclusive) {
+            s << " demoted:" << _demotions[k];
+        }
+        s << std::endl;
+    }
+    s << "backing: blocks:" << _backing_blocks
+        << " share:" << (_blocks ? 1.0 * _backing_blocks / _blocks : 0.0) << std::endl;
+    // 直方图按纳秒记录，输出换算为微秒
+    s << "latency(us):"
+        << " avg:" << (_requests ? _latency_sum_us / _requests : 0.0)
+        << " p50:" << _latency_ns.percentile(0.5) / 1000.0
+        << " p99:" << _latency_ns.percentile(0.99) / 1000.0
+        << " p999:" << _latency_ns.percentile(0.999) / 1000.0
+        << " max:" << _latency_ns.max() / 1000.0 << std::endl;
+    return s.str();
+}
+
+bool parse_hierarchy(const std::string& spec, std::vector<tier_config>* tiers, tier_config* backing,
+    std::string* error) {
+    tiers->clear();
+    *backing = tier_config();
+    backing->policy = "backing";
+    backing->hit_us = 5000;
+    backing->bandwidth_mb = 150;
+    std::vector<std::string> levels = split(spec, '/');
+    for (size_t i = 0; i < levels.size(); ++i) {
+        std::vector<std::string> fields = split(levels[i], ',');
+        if (fields.empty() || fields[0].empty()) {
+            *error = "empty tier in '" + spec + "'";
+            return false;
+        }
+        bool is_backing = fields[0] == "backing";
+        if (is_backing && i + 1 != levels.size()) {
+            *error = "backing must be the last tier";
+            return false;
+        }
+        tier_config t = is_backing ? *backing : tier_config();
+        t.policy = fields[0];
+        for (size_t f = 1; f < fields.size(); ++f) {
+            size_t eq = fields[f].find('=');
+            if (eq == std::string::npos) {
+                *error = "expected key=value, got '" + fields[f] + "'";
+                return false;
+            }
+            std::string key = fields[f].substr(0, eq);
+            if (key == "alloc" && !is_backing) {
+                if (!parse_policy_allocator(fields[f].substr(eq + 1), &t.allocator)) {
+                    *error = "unknown allocator '" + fields[f].substr(eq + 1) + "'";
+                    return false;
+                }
+                continue;
+            }
+            double value = std::atof(fields[f].c_str() + eq + 1);
+            if (key == "c" && !is_backing) {
+                t.capacity = static_cast<int>(value);
+            }
+            else if (key == "hit") {
+                t.hit_us = value;
+            }
+            else if (key == "miss" && !is_backing) {
+                t.miss_us = value;
+            }
+            else if (key == "bw") {
+                t.bandwidth_mb = value;
+            }
+            else {
+                *error = "unknown key '" + key + "' for " + t.policy;
+                return false;
+            }
+        }
+        if (is_backing) {
+            *backing = t;
+        }
+        else if (t.capacity <= 0) {
+            *error = t.policy + " needs c=<capacity>";
+            return false;
+        }
+        else {
+            tiers->push_back(t);
+        }
+    }
+    if (tiers->empty()) {
+        *error = "no cache tiers in '" + spec + "'";
+        return false;
+    }
+    return true;
+}
+
+int run_hierarchy(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " --hierarchy <trace> <tier>/<tier>/.../backing[,...]"
+            << " [--exclusive] [--warmup N|P%]\n"
+            << "       tier: <policy>,c=<blocks>[,hit=<us>][,miss=<us>][,bw=<MB/s>][,alloc=malloc|pool|pool_huge]\n"
+            << "       e.g.  lru,c=10000,hit=0.1,bw=20000/ceph_tier,c=200000,hit=80,miss=5,bw=2000/backing,hit=8000,bw=150"
+            << std::endl;
+        return 1;
+    }
+    std::string trace = argv[2];
+    std::vector<tier_config> tiers;
+    tier_config backing;
+    std::string error;
+    if (!parse_hierarchy(argv[3], &tiers, &backing, &error)) {
+        std::cerr << "bad hierarchy: " << error << std::endl;
+        return 1;
+    }
+    bool exclusive = false;
+    uint64_t warmup_requests = 0;
+    double warmup_fraction = 0;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--exclusive") {
+            exclusive = true;
+        }
+        else if (arg == "--warmup" && i + 1 < argc) {
+            std::string v = argv[++i];
+            if (!v.empty() && v.back() == '%') {
+                warmup_fraction = std::stod(v.substr(0, v.size() - 1)) / 100.0;
+            }
+            else {
+                warmup_requests = std::stoull(v);
+            }
+        }
+        else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<TraceSource> source = open_trace(trace);
+    if (!source) {
+        std::cerr << "can't not find trace_file" << std::endl;
+        return -1;
+    }
+    TierHierarchy h(tiers, backing, exclusive, trace);
+    if (!h.init(&error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    // 预热按请求行数计，结束时统计清零
+    if (warmup_fraction > 0) {
+        warmup_requests = static_cast<uint64_t>(warmup_fraction * source->length());
+    }
+    uint64_t lines = 0;
+    trace_line l;
+    while (source->next(l)) {
+        h.access_line(l);
+        if (++lines == warmup_requests) {
+            h.reset_stats();
+        }
+    }
+    std::cout << h.statics();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+// 多级缓存模拟：SCORE.exe --hierarchy <trace> <规格> [--exclusive] [--warmup N|P%]
+// 每一级可以是任意策略，最后接后备存储；按各级的服务时间和带宽估计每个请求的访问延迟
+//
+// 规格：<级>/<级>/.../backing[,...]，级之间用 / 分隔，从上到下
+//   级：<策略名>,c=<容量（块）>[,hit=<命中服务时间 us>][,miss=<未命中查找开销 us>][,bw=<带宽 MB/s>]
+//       [,alloc=malloc|pool|pool_huge]（该级策略容器的分配器，默认按本次运行的选择）
+//   backing：后备存储，只有 hit 和 bw（默认 hit=5000,bw=150，相当于机械盘）
+// 例：lru,c=10000,hit=0.1,bw=20000/ceph_tier,c=200000,hit=80,miss=5,bw=2000/backing,hit=8000,bw=150
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "latency.h"
+#include "policy.h"
+#include "TraceLine.h"
+
+struct tier_config {
+    std::string policy;   // make_policy 的策略名，后备存储为 "backing"
+    int capacity = 0;
+    double hit_us = 0;    // 命中时的固定服务时间
+    double miss_us = 0;   // 未命中时的查找开销
+    double bandwidth_mb = 0;  // 传输带宽，0 表示不计传输时间
+    policy_allocator allocator = current_policy_allocator();
+};
+
+/**
+ * 两种放置方式：
+ *   包含（默认）：请求从上往下逐级访问，未命中的级都会放入一份副本（提升），下级保留原副本，不降级
+ *   独占：一个块只存在于一级。下级命中时移到第一级；被挤出的块降级到下一级，最后一级的淘汰直接丢弃。
+ *        需要策略支持 contains/erase（见 CachePolicy::supports_exclusive），
+ *        降级按策略报告的实际淘汰对象（set_eviction_log）；不报告淘汰的策略（Ceph 分层缓存）挤出的块不降级
+ * 一个请求（trace 的一行）按级串行访问：到达的最深一级之前，有块命中的级计命中服务时间和传输时间，
+ * 没有块命中的级计查找开销；最深一级计命中服务时间和传输时间
+ */
+class TierHierarchy {
+public:
+    TierHierarchy(const std::vector<tier_config>& tiers, const tier_config& backing, bool exclusive,
+        const std::string& trace_name);
+
+    // 创建各级策略；策略名无效或独占模式下有策略不支持时返回 false
+    bool init(std::string* error);
+    void access_line(const trace_line& l);
+    // 计数器和延迟直方图清零（预热结束时），各级缓存内容不变
+    void reset_stats();
+    std::string statics() const;
+    const CachePolicy& tier(size_t k) const { return *_tiers[k]; }
+
+private:
+    size_t lookup_inclusive(int block);
+    size_t lookup_exclusive(int block);
+    // 独占模式：放入第 k 级，被挤出的块降级到第 k+1 级
+    void admit(size_t k, int block);
+    static double service_us(const tier_config& t, double bytes);
+
+    std::vector<tier_config> _config;
+    tier_config _backing;
+    bool _exclusive;
+    std::string _trace_name;
+    std::vector<std::unique_ptr<CachePolicy>> _tiers;
+    SimContext _ctx;
+    bool _records;               // 是否有策略需要 trace_records
+    uint64_t _block_count;       // TDC 周期计数，预热后不清零
+    std::vector<uint64_t> _lookups;
+    std::vector<uint64_t> _hits;
+    std::vector<uint64_t> _demotions;
+    std::vector<std::vector<int>> _evicted;  // 独占模式：每一级最近一次 get() 淘汰的对象
+    std::vector<double> _line_bytes;  // 当前请求在每一级（含后备存储）读取的字节数
+    uint64_t _requests;
+    uint64_t _blocks;
+    uint64_t _backing_blocks;
+    loglin_hist_t _latency_ns;
+    double _latency_sum_us;
+};
+
+// 解析多级缓存规格，格式见文件开头
+bool parse_hierarchy(const std::string& spec, std::vector<tier_config>* tiers, tier_config* backing,
+    std::string* error);
+
+int run_hierarchy(int argc, char** argv);
@@ -0,0 +1,72 @@
+#pragma once
+// 以下标链接的侵入式双向链表：节点放在调用方的数组（对象池）里，链表只记录首尾下标，
+// 插入和移除不分配内存。一个节点可以带多个 list_hook，同时挂在多条链表上
+
+#include <cstdint>
+#include <vector>
+
+struct list_hook {
+    static const uint32_t kNil = 0xffffffffu;
+    uint32_t prev = kNil;  // 靠近表头一侧
+    uint32_t next = kNil;
+};
+
+template <class Node, list_hook Node::*Hook>
+class index_list {
+public:
+    static const uint32_t kNil = list_hook::kNil;
+
+    explicit index_list(std::vector<Node>& nodes) : _nodes(nodes), _front(kNil), _back(kNil), _size(0) {}
+
+    uint32_t front() const { return _front; }
+    uint32_t back() const { return _back; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    void push_front(uint32_t i) {
+        list_hook& h = hook(i);
+        h.prev = kNil;
+        h.next = _front;
+        if (_front != kNil) {
+            hook(_front).prev = i;
+        }
+        else {
+            _back = i;
+        }
+        _front = i;
+        ++_size;
+    }
+
+    void remove(uint32_t i) {
+        list_hook& h = hook(i);
+        if (h.prev != kNil) {
+            hook(h.prev).next = h.next;
+        }
+        else {
+            _front = h.next;
+        }
+        if (h.next != kNil) {
+            hook(h.next).prev = h.prev;
+        }
+        else {
+            _back = h.prev;
+        }
+        h.prev = h.next = kNil;
+        --_size;
+    }
+
+    void move_to_front(uint32_t i) {
+        if (_front != i) {
+            remove(i);
+            push_front(i);
+        }
+    }
+
+private:
+    list_hook& hook(uint32_t i) { return _nodes[i].*Hook; }
+
+    std::vector<Node>& _nodes;
+    uint32_t _front;
+    uint32_t _back;
+    size_t _size;
+};
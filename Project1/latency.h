@@ -0,0 +1,185 @@
+#pragma once
+// get() 延迟统计：对数-线性直方图（HDR 风格）+ 低开销计时 + 按命中/未命中分开记录
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define LATENCY_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LATENCY_HAS_RDTSC 1
+#endif
+
+// 计时源：x86 上用 rdtsc，其他平台退回 steady_clock（纳秒）
+inline uint64_t latency_ticks() {
+#ifdef LATENCY_HAS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * 对数-线性直方图
+ * 按 2 的幂分段，每个 [2^k, 2^(k+1)) 再等分为 2^kSubBits 个线性子箱，
+ * 相对误差不超过 2^-kSubBits；小于 2^kSubBits 的值精确记录。
+ * 与 histogram.h 的 pow2_hist_t 相互独立：计数为 64 位，按 uint64_t 取值
+ */
+struct loglin_hist_t {
+    static const unsigned kSubBits = 5;
+    static const unsigned kSubCount = 1u << kSubBits;
+
+    loglin_hist_t() : counts((65 - kSubBits) * kSubCount, 0), total(0), max_value(0) {}
+
+    void add(uint64_t v) {
+        ++counts[index_of(v)];
+        ++total;
+        if (v > max_value) {
+            max_value = v;
+        }
+    }
+
+    void add(const loglin_hist_t& o) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += o.counts[i];
+        }
+        total += o.total;
+        if (o.max_value > max_value) {
+            max_value = o.max_value;
+        }
+    }
+
+    void clear() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        max_value = 0;
+    }
+
+    bool empty() const { return total == 0; }
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+
+    // 第 q 分位（0 < q <= 1）所在子箱的上界，不超过最大值
+    uint64_t percentile(double q) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * total);
+        if (rank < 1) {
+            rank = 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t upper = upper_of(i);
+                return upper < max_value ? upper : max_value;
+            }
+        }
+        return max_value;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t max_value;
+
+private:
+    // 二进制位数，v == 0 时为 0；二分移位，不依赖编译器内建函数
+    static unsigned bit_length(uint64_t v) {
+        unsigned n = 0;
+        if (v >> 32) { v >>= 32; n += 32; }
+        if (v >> 16) { v >>= 16; n += 16; }
+        if (v >> 8) { v >>= 8; n += 8; }
+        if (v >> 4) { v >>= 4; n += 4; }
+        if (v >> 2) { v >>= 2; n += 2; }
+        if (v >> 1) { v >>= 1; n += 1; }
+        return n + static_cast<unsigned>(v);
+    }
+
+    static size_t index_of(uint64_t v) {
+        if (v < kSubCount) {
+            return static_cast<size_t>(v);
+        }
+        unsigned b = bit_length(v);  // v 位于 [2^(b-1), 2^b)
+        unsigned shift = b - 1 - kSubBits;
+        return static_cast<size_t>(b - kSubBits) * kSubCount + static_cast<size_t>((v >> shift) - kSubCount);
+    }
+
+    static uint64_t lower_of(size_t i) {
+        if (i < kSubCount) {
+            return i;
+        }
+        unsigned b = static_cast<unsigned>(i / kSubCount) + kSubBits;
+        unsigned shift = b - 1 - kSubBits;
+        return (static_cast<uint64_t>(kSubCount + i % kSubCount)) << shift;
+    }
+
+    static uint64_t upper_of(size_t i) {
+        if (i < kSubCount) {
+            return i;
+        }
+        unsigned shift = static_cast<unsigned>(i / kSubCount) - 1;
+        return lower_of(i) + ((1ULL << shift) - 1);
+    }
+};
+
+// 单个策略的 get() 延迟，命中与未命中分开统计（单位：计时源的 tick）
+struct latency_stats_t {
+    loglin_hist_t hit;
+    loglin_hist_t miss;
+
+    void add(bool is_hit, uint64_t ticks) {
+        (is_hit ? hit : miss).add(ticks);
+    }
+
+    // ns_per_tick 由调用者校准
+    std::string report(const std::string& name, double ns_per_tick) const {
+        std::stringstream s;
+        s << "latency(ns) " << name << ":";
+        append(s, " hit", hit, ns_per_tick);
+        append(s, " miss", miss, ns_per_tick);
+        s << std::endl;
+        return s.str();
+    }
+
+private:
+    static void append(std::stringstream& s, const char* tag, const loglin_hist_t& h, double ns_per_tick) {
+        s << tag << "[n:" << h.count();
+        if (!h.empty()) {
+            s << " p50:" << static_cast<uint64_t>(h.percentile(0.5) * ns_per_tick)
+                << " p99:" << static_cast<uint64_t>(h.percentile(0.99) * ns_per_tick)
+                << " p999:" << static_cast<uint64_t>(h.percentile(0.999) * ns_per_tick)
+                << " max:" << static_cast<uint64_t>(h.max() * ns_per_tick);
+        }
+        s << "]";
+    }
+};
+
+// 把计时源的 tick 换算为纳秒：在一段时间的两端同时读取 tick 和 steady_clock
+class latency_clock_calibration {
+public:
+    latency_clock_calibration() { start(); }
+
+    void start() {
+        _tick0 = latency_ticks();
+        _time0 = std::chrono::steady_clock::now();
+    }
+
+    double ns_per_tick() const {
+        uint64_t ticks = latency_ticks() - _tick0;
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _time0).count());
+        return ticks == 0 ? 1.0 : ns / ticks;
+    }
+
+private:
+    uint64_t _tick0;
+    std::chrono::steady_clock::time_point _time0;
+};
@@ -0,0 +1,328 @@
+#include "learned.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+const double kBlockBytes = 4096;
+const float kStatsDecay = 0.01f;   // 特征均值/方差的滑动平均系数
+const float kMinVar = 1e-2f;
+const uint32_t kTrainSampleShift = 3;  // 只有 1/8 的 key 参与训练
+
+// key 的哈希低位为 0 时参与训练，对同一 key 结果固定，标注时只需查这部分 key
+inline bool train_sampled(int target) {
+    uint32_t h = static_cast<uint32_t>(target) * 0x9e3779b1u;
+    return (h >> (32 - kTrainSampleShift)) == 0;
+}
+
+// log2 的二次多项式近似（x >= 1，误差约 0.005），只有整数和乘加运算，便于向量化
+inline float fast_log2(float x) {
+    int32_t i;
+    std::memcpy(&i, &x, sizeof(i));
+    float e = static_cast<float>(((i >> 23) & 0xff) - 127);
+    i = (i & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &i, sizeof(m));
+    return e + (-0.34484843f * m + 2.02466578f) * m - 0.67487759f;
+}
+
+// 2^x 的近似（x <= 0），与 fast_log2 同样只用整数和乘加运算
+inline float fast_exp2(float x) {
+    x = std::max(x, -126.0f);
+    float fl = std::floor(x);
+    float f = x - fl;
+    int32_t i = (static_cast<int32_t>(fl) + 127) << 23;
+    float p;
+    std::memcpy(&p, &i, sizeof(p));
+    return p * ((0.33718944f * f + 0.65763628f) * f + 1.00172476f);
+}
+
+inline float sigmoid(float z) {
+    return 1.0f / (1.0f + std::exp(-z));
+}
+
+} // namespace
+
+const int LearnedCache::kFeatures;
+const int LearnedCache::kMaxCandidates;
+const int LearnedCache::kBatch;
+
+LearnedCache::LearnedCache(int c, std::string file_name, int candidates, policy_allocator alloc) :
+    _resource(make_policy_resource(alloc)), _capacity(std::max(0, c)), _file_name(file_name),
+    _candidates(std::min(kMaxCandidates, std::max(1, candidates))),
+    _horizon(static_cast<uint64_t>(std::max(1, c))), _half_life(static_cast<float>(std::max(1, c))),
+    _clock(0), _table(0, _resource.get()), _learning_rate(0.05f),
+    _pending(_resource.get()), _pending_base(0), _pending_index(0, _resource.get()), _batch_size(0),
+    _rng(0x2545f4914f6cdd1dULL), _trained(0), _positives(0), _hit_count(0), _get_count(0), _eviction_count(0) {
+    size_t n = static_cast<size_t>(_capacity);
+    _keys.reserve(n);
+    _last.reserve(n);
+    _gap1.reserve(n);
+    _gap2.reserve(n);
+    _gap3.reserve(n);
+    _freq.reserve(n);
+    _blocks.reserve(n);
+    _last_request.reserve(n);
+    _table.reserve(n);
+    for (int f = 0; f < kFeatures; ++f) {
+        _w[f] = 0;
+        _mean[f] = 0;
+        _var[f] = 1;
+    }
+    // 先验：越久未访问越先淘汰
+    _w[1] = -1;
+}
+
+bool LearnedCache::get(int target, double request_bytes, int request_number) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    ++_get_count;
+    ++_clock;
+    expire();
+    if (train_sampled(target)) {
+        label(target);
+    }
+
+    auto it = _table.find(target);
+    if (it != _table.end()) {
+        ++_hit_count;
+        uint32_t s = it->second;
+        uint64_t gap = _clock - _last[s];
+        _gap3[s] = _gap2[s];
+        _gap2[s] = _gap1[s];
+        _gap1[s] = static_cast<uint32_t>(std::min<uint64_t>(gap, UINT32_MAX));
+        _freq[s] = decayed_freq(s) + 1;
+        _last[s] = _clock;
+        _last_request[s] = request_number;
+        return true;
+    }
+
+    if (_keys.size() >= static_cast<size_t>(_capacity)) {
+        evict(request_number);
+    }
+    // 没有历史间隔时记为 4H，即比标注窗口长得多
+    uint32_t no_gap = static_cast<uint32_t>(std::min<uint64_t>(4 * _horizon, UINT32_MAX));
+    _table.emplace(target, static_cast<uint32_t>(_keys.size()));
+    _keys.push_back(target);
+    _last.push_back(_clock);
+    _gap1.push_back(no_gap);
+    _gap2.push_back(no_gap);
+    _gap3.push_back(no_gap);
+    _freq.push_back(1);
+    _blocks.push_back(static_cast<float>(std::max(1.0, request_bytes / kBlockBytes)));
+    _last_request.push_back(request_number);
+    return false;
+}
+
+void LearnedCache::evict(int request_number) {
+    int n = gather(request_number);
+    score(n);
+    int worst = 0;
+    for (int i = 1; i < n; ++i) {
+        if (_cand_score[i] < _cand_score[worst]) {
+            worst = i;
+        }
+    }
+    // 候选中第一个参与训练的 key 作为训练样本，特征即打分时所用的
+    int pick = 0;
+    while (pick < n && !train_sampled(_keys[_cand_slot[pick]])) {
+        ++pick;
+    }
+    int key = pick < n ? _keys[_cand_slot[pick]] : 0;
+    if (pick < n && _pending_index.find(key) == _pending_index.end()) {
+        sample smp;
+        smp.target = key;
+        smp.time = _clock;
+        smp.labelled = false;
+        for (int f = 0; f < kFeatures; ++f) {
+            smp.x[f] = _cand_x[f][pick];
+        }
+        _pending_index.emplace(key, _pending_base + _pending.size());
+        _pending.push_back(smp);
+    }
+    remove_slot(_cand_slot[worst]);
+    ++_eviction_count;
+}
+
+void LearnedCache::remove_slot(uint32_t slot) {
+    _table.erase(_keys[slot]);
+    uint32_t last = static_cast<uint32_t>(_keys.size() - 1);
+    if (slot != last) {
+        _keys[slot] = _keys[last];
+        _last[slot] = _last[last];
+        _gap1[slot] = _gap1[last];
+        _gap2[slot] = _gap2[last];
+        _gap3[slot] = _gap3[last];
+        _freq[slot] = _freq[last];
+        _blocks[slot] = _blocks[last];
+        _last_request[slot] = _last_request[last];
+        _table[_keys[slot]] = slot;
+    }
+    _keys.pop_back();
+    _last.pop_back();
+    _gap1.pop_back();
+    _gap2.pop_back();
+    _gap3.pop_back();
+    _freq.pop_back();
+    _blocks.pop_back();
+    _last_request.pop_back();
+}
+
+int LearnedCache::gather(int request_number) {
+    uint32_t size = static_cast<uint32_t>(_keys.size());
+    int n = static_cast<int>(std::min<uint32_t>(size, static_cast<uint32_t>(_candidates)));
+    for (int i = 0; i < n; ++i) {
+        _cand_slot[i] = size <= static_cast<uint32_t>(_candidates) ? static_cast<uint32_t>(i) : next_random(size);
+    }
+    // 按槽位随机读取原始特征
+    for (int i = 0; i < n; ++i) {
+        uint32_t s = _cand_slot[i];
+        _cand_x[0][i] = 1;
+        _cand_x[1][i] = static_cast<float>(_clock - _last[s]);
+        _cand_x[2][i] = static_cast<float>(_gap1[s]);
+        _cand_x[3][i] = static_cast<float>(_gap2[s]);
+        _cand_x[4][i] = static_cast<float>(_gap3[s]);
+        _cand_x[5][i] = decayed_freq(s);
+        _cand_x[6][i] = _blocks[s] - 1;
+        _cand_x[7][i] = static_cast<float>(std::abs(static_cast<int64_t>(request_number) - _last_request[s]));
+    }
+    // 逐特征变换，内层循环连续且无分支
+    for (int f = 1; f < kFeatures; ++f) {
+        float* x = _cand_x[f];
+        for (int i = 0; i < n; ++i) {
+            x[i] = fast_log2(1.0f + x[i]);
+        }
+    }
+    return n;
+}
+
+void LearnedCache::score(int n) {
+    for (int i = 0; i < n; ++i) {
+        _cand_score[i] = _w[0];
+    }
+    for (int f = 1; f < kFeatures; ++f) {
+        const float* x = _cand_x[f];
+        float m = _mean[f];
+        float k = _w[f] / std::sqrt(_var[f]);
+        for (int i = 0; i < n; ++i) {
+            _cand_score[i] += k * (x[i] - m);
+        }
+    }
+}
+
+void LearnedCache::label(int target) {
+    auto it = _pending_index.find(target);
+    if (it == _pending_index.end()) {
+        return;
+    }
+    sample& s = _pending[static_cast<size_t>(it->second - _pending_base)];
+    s.labelled = true;
+    learn(s.x, 1);
+    _pending_index.erase(it);
+}
+
+void LearnedCache::expire() {
+    while (!_pending.empty() && _clock - _pending.front().time > _horizon) {
+        sample& s = _pending.front();
+        if (!s.labelled) {
+            learn(s.x, 0);
+            _pending_index.erase(s.target);
+        }
+        _pending.pop_front();
+        ++_pending_base;
+    }
+}
+
+void LearnedCache::learn(const float* x, float y) {
+    std::copy(x, x + kFeatures, _batch_x[_batch_size]);
+    _batch_y[_batch_size] = y;
+    if (++_batch_size == kBatch) {
+        train_batch();
+        _batch_size = 0;
+    }
+}
+
+void LearnedCache::train_batch() {
+    // 第一批直接用批内统计量初始化均值和方差，之后做滑动平均
+    for (int f = 1; f < kFeatures; ++f) {
+        if (_trained == 0) {
+            float sum = 0;
+            float sq = 0;
+            for (int b = 0; b < kBatch; ++b) {
+                sum += _batch_x[b][f];
+                sq += _batch_x[b][f] * _batch_x[b][f];
+            }
+            _mean[f] = sum / kBatch;
+            _var[f] = std::max(kMinVar, sq / kBatch - _mean[f] * _mean[f]);
+            continue;
+        }
+        for (int b = 0; b < kBatch; ++b) {
+            float d = _batch_x[b][f] - _mean[f];
+            _mean[f] += kStatsDecay * d;
+            _var[f] = std::max(kMinVar, (1 - kStatsDecay) * (_var[f] + kStatsDecay * d * d));
+        }
+    }
+
+    float inv_std[kFeatures];
+    for (int f = 0; f < kFeatures; ++f) {
+        inv_std[f] = f == 0 ? 1.0f : 1.0f / std::sqrt(_var[f]);
+    }
+    float grad[kFeatures] = {};
+    for (int b = 0; b < kBatch; ++b) {
+        float z[kFeatures];
+        z[0] = 1;
+        for (int f = 1; f < kFeatures; ++f) {
+            z[f] = (_batch_x[b][f] - _mean[f]) * inv_std[f];
+        }
+        float logit = 0;
+        for (int f = 0; f < kFeatures; ++f) {
+            logit += _w[f] * z[f];
+        }
+        float g = sigmoid(logit) - _batch_y[b];
+        for (int f = 0; f < kFeatures; ++f) {
+            grad[f] += g * z[f];
+        }
+        if (_batch_y[b] > 0) {
+            ++_positives;
+        }
+    }
+    for (int f = 0; f < kFeatures; ++f) {
+        _w[f] -= _learning_rate * grad[f] / kBatch;
+    }
+    _trained += kBatch;
+}
+
+uint32_t LearnedCache::next_random(uint32_t bound) {
+    // xorshift64，结果可复现；乘法取高位代替取模
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 7;
+    _rng ^= _rng << 17;
+    return static_cast<uint32_t>(((_rng >> 32) * bound) >> 32);
+}
+
+float LearnedCache::decayed_freq(uint32_t slot) const {
+    return _freq[slot] * fast_exp2(-static_cast<float>(_clock - _last[slot]) / _half_life);
+}
+
+std::string LearnedCache::statics() {
+    static const char* names[kFeatures] = { "bias", "age", "gap1", "gap2", "gap3", "freq", "size", "request" };
+    std::stringstream s;
+    s << "trace:" << _file_name << " learned_cache:"
+        << " cache_size:" << _capacity
+        << " request:" << _get_count
+        << " hit:" << _hit_count
+        << " miss:" << _get_count - _hit_count
+        << " hit_rate:" << (_get_count ? 1.0 * _hit_count / _get_count : 0.0)
+        << " candidates:" << _candidates
+        << " trained:" << _trained
+        << " positive_rate:" << (_trained ? 1.0 * _positives / _trained : 0.0)
+        << " weights:";
+    for (int f = 0; f < kFeatures; ++f) {
+        s << (f ? "," : "") << names[f] << "=" << _w[f];
+    }
+    s << std::endl;
+    return s.str();
+}
@@ -0,0 +1,106 @@
+#pragma once
+// 轻量学习型淘汰（LRB 思路的简化版）：在线逻辑回归预测对象在接下来 H 次访问内是否会再被访问，
+// 淘汰时随机抽 K 个（默认 16）驻留对象，淘汰预测概率最低的一个
+//   特征：距上次访问的间隔、最近三次访问间隔、按半衰期衰减的访问次数、大小（块数）、
+//         与上次访问相隔的 request_number 差，均取 log2(1 + x)，再按滑动均值/方差标准化
+//   标注：按哈希抽取 1/8 的 key 参与训练。每次淘汰从候选中取一个这样的对象记下当时的特征，
+//         H（= 缓存大小）次访问内再被访问记为 1，到期仍未访问记为 0；凑满一批后做一次 SGD。
+//         训练样本与打分时的特征分布一致
+//   初始权重偏向“越久未访问越先淘汰”，模型学到东西之前行为接近随机抽样的 LRU
+// 驻留对象的特征按列存放（下标即槽位号），打分时先把 K 个候选收集成按特征排列的小矩阵，
+// 逐特征对所有候选做同一运算，循环可由编译器向量化。淘汰时用最后一个槽位填补空位，保持数组紧凑
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "memory_resource.h"
+
+class LearnedCache {
+public:
+    explicit LearnedCache(int c, std::string file_name, int candidates = 16,
+        policy_allocator alloc = current_policy_allocator());
+
+    LearnedCache(const LearnedCache&) = delete;
+    LearnedCache& operator=(const LearnedCache&) = delete;
+
+    // request_bytes 为整个请求的字节数，request_number 取自 trace 行
+    bool get(int target, double request_bytes, int request_number);
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _keys.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+
+    static const int kFeatures = 8;       // 含常数项
+    static const int kMaxCandidates = 64;
+    static const int kBatch = 32;
+
+private:
+    struct sample {
+        int target;
+        uint64_t time;
+        bool labelled;
+        float x[kFeatures];
+    };
+
+    void evict(int request_number);
+    void remove_slot(uint32_t slot);
+    // 候选特征写入 _cand_x（按特征排列），返回候选数
+    int gather(int request_number);
+    // 对 _cand_x 中的 n 个候选打分（logit）写入 _cand_score
+    void score(int n);
+    void label(int target);
+    void expire();
+    void learn(const float* x, float y);
+    void train_batch();
+    // [0, bound) 内的随机数
+    uint32_t next_random(uint32_t bound);
+    float decayed_freq(uint32_t slot) const;
+
+    std::unique_ptr<memory_resource> _resource;  // 哈希表和待标注队列用
+    int _capacity;
+    std::string _file_name;
+    int _candidates;
+    uint64_t _horizon;        // 标注窗口 H（访问次数）
+    float _half_life;         // 访问次数衰减的半衰期（访问次数）
+    uint64_t _clock;          // 逻辑时间，每次访问加一
+
+    // 驻留对象，按槽位存放
+    std::vector<int> _keys;
+    std::vector<uint64_t> _last;          // 上次访问的逻辑时间
+    std::vector<uint32_t> _gap1;          // 最近一次访问间隔
+    std::vector<uint32_t> _gap2;
+    std::vector<uint32_t> _gap3;
+    std::vector<float> _freq;             // 截至 _last 的衰减访问次数
+    std::vector<float> _blocks;           // 大小（块数）
+    std::vector<int> _last_request;       // 上次访问的 request_number
+    resource_map<int, uint32_t> _table;  // target -> 槽位
+
+    // 模型
+    float _w[kFeatures];
+    float _mean[kFeatures];
+    float _var[kFeatures];
+    float _learning_rate;
+
+    // 打分用的候选矩阵
+    uint32_t _cand_slot[kMaxCandidates];
+    float _cand_x[kFeatures][kMaxCandidates];
+    float _cand_score[kMaxCandidates];
+
+    // 等待标注的样本，按记录时间排列；每个对象同时最多一个
+    std::deque<sample, resource_allocator<sample>> _pending;
+    uint64_t _pending_base;   // _pending.front() 的序号
+    resource_map<int, uint64_t> _pending_index;  // target -> 样本序号
+    float _batch_x[kBatch][kFeatures];
+    float _batch_y[kBatch];
+    int _batch_size;
+
+    uint64_t _rng;
+    uint64_t _trained;
+    uint64_t _positives;
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _eviction_count;
+};
@@ -0,0 +1,193 @@
+#include "lfu.h"
+#include <algorithm>
+#include <sstream>
+
+LFUCache::LFUCache(int c, std::string file_name, bool dynamic_aging) :
+    _capacity(std::max(0, c)), _file_name(file_name), _aging(dynamic_aging), _age(0),
+    _entries(static_cast<size_t>(std::max(0, c))), _buckets(static_cast<size_t>(std::max(0, c)) + 1),
+    _first(kNil), _bucket_count(0), _hit_count(0), _get_count(0), _eviction_count(0) {
+    _free_entries.reserve(_entries.size());
+    for (size_t i = _entries.size(); i > 0; --i) {
+        _free_entries.push_back(static_cast<uint32_t>(i - 1));
+    }
+    _free_buckets.reserve(_buckets.size());
+    for (size_t i = _buckets.size(); i > 0; --i) {
+        _free_buckets.push_back(static_cast<uint32_t>(i - 1));
+    }
+    _table.reserve(_entries.size());
+}
+
+bool LFUCache::get(int target) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    ++_get_count;
+    auto it = _table.find(target);
+    if (it != _table.end()) {
+        ++_hit_count;
+        uint32_t e = it->second;
+        uint32_t b = _entries[e].bucket;
+        uint64_t p = _buckets[b].priority + 1;
+        uint32_t nb = _buckets[b].next;
+        if (nb == kNil || _buckets[nb].priority != p) {
+            nb = new_bucket(p, b);
+        }
+        remove(e);
+        push_front(nb, e);
+        return true;
+    }
+
+    if (_table.size() >= static_cast<size_t>(_capacity)) {
+        evict();
+    }
+    // 最小桶的优先级不小于 L，所以 L + 1 的桶只可能是第一个或第二个
+    uint64_t p = _age + 1;
+    uint32_t b = _first;
+    if (b != kNil && _buckets[b].priority < p) {
+        uint32_t nb = _buckets[b].next;
+        b = nb != kNil && _buckets[nb].priority == p ? nb : new_bucket(p, b);
+    }
+    else if (b == kNil || _buckets[b].priority != p) {
+        b = new_bucket(p, kNil);
+    }
+    uint32_t e = _free_entries.back();
+    _free_entries.pop_back();
+    _entries[e].target = target;
+    push_front(b, e);
+    _table.emplace(target, e);
+    return false;
+}
+
+void LFUCache::evict() {
+    uint32_t e = _buckets[_first].tail;
+    if (_aging) {
+        _age = _buckets[_first].priority;
+    }
+    if (_eviction_log) {
+        _eviction_log->push_back(_entries[e].target);
+    }
+    _table.erase(_entries[e].target);
+    remove(e);
+    _free_entries.push_back(e);
+    ++_eviction_count;
+}
+
+int LFUCache::victim() const {
+    if (_first == kNil || _table.size() < static_cast<size_t>(_capacity)) {
+        return -1;
+    }
+    return _entries[_buckets[_first].tail].target;
+}
+
+void LFUCache::residents(std::vector<int>& out) const {
+    for (uint32_t b = _first; b != kNil; b = _buckets[b].next) {
+        for (uint32_t e = _buckets[b].tail; e != kNil; e = _entries[e].prev) {
+            out.push_back(_entries[e].target);
+        }
+    }
+}
+
+bool LFUCache::erase(int target) {
+    auto it = _table.find(target);
+    if (it == _table.end()) {
+        return false;
+    }
+    uint32_t e = it->second;
+    _table.erase(it);
+    remove(e);
+    _free_entries.push_back(e);
+    return true;
+}
+
+// 在 after 之后插入新桶，after 为 kNil 时插在最前
+uint32_t LFUCache::new_bucket(uint64_t priority, uint32_t after) {
+    uint32_t b = _free_buckets.back();
+    _free_buckets.pop_back();
+    bucket& nb = _buckets[b];
+    nb.priority = priority;
+    nb.head = nb.tail = kNil;
+    nb.prev = after;
+    nb.next = after == kNil ? _first : _buckets[after].next;
+    if (nb.next != kNil) {
+        _buckets[nb.next].prev = b;
+    }
+    if (after == kNil) {
+        _first = b;
+    }
+    else {
+        _buckets[after].next = b;
+    }
+    ++_bucket_count;
+    return b;
+}
+
+void LFUCache::free_bucket(uint32_t b) {
+    bucket& ob = _buckets[b];
+    if (ob.prev != kNil) {
+        _buckets[ob.prev].next = ob.next;
+    }
+    else {
+        _first = ob.next;
+    }
+    if (ob.next != kNil) {
+        _buckets[ob.next].prev = ob.prev;
+    }
+    _free_buckets.push_back(b);
+    --_bucket_count;
+}
+
+void LFUCache::push_front(uint32_t b, uint32_t e) {
+    entry& x = _entries[e];
+    bucket& bk = _buckets[b];
+    x.bucket = b;
+    x.prev = kNil;
+    x.next = bk.head;
+    if (bk.head != kNil) {
+        _entries[bk.head].prev = e;
+    }
+    else {
+        bk.tail = e;
+    }
+    bk.head = e;
+}
+
+void LFUCache::unlink(uint32_t e) {
+    entry& x = _entries[e];
+    bucket& bk = _buckets[x.bucket];
+    if (x.prev != kNil) {
+        _entries[x.prev].next = x.next;
+    }
+    else {
+        bk.head = x.next;
+    }
+    if (x.next != kNil) {
+        _entries[x.next].prev = x.prev;
+    }
+    else {
+        bk.tail = x.prev;
+    }
+}
+
+void LFUCache::remove(uint32_t e) {
+    uint32_t b = _entries[e].bucket;
+    unlink(e);
+    if (_buckets[b].head == kNil) {
+        free_bucket(b);
+    }
+}
+
+std::string LFUCache::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << (_aging ? " lfu_da_cache:" : " lfu_cache:")
+        << " cache_size:" << _capacity
+        << " request:" << _get_count
+        << " hit:" << _hit_count
+        << " miss:" << _get_count - _hit_count
+        << " hit_rate:" << (_get_count ? 1.0 * _hit_count / _get_count : 0.0)
+        << " buckets:" << _bucket_count;
+    if (_aging) {
+        s << " age:" << _age;
+    }
+    s << std::endl;
+    return s.str();
+}
@@ -0,0 +1,77 @@
+#pragma once
+// O(1) LFU：按访问次数分桶，桶按次数升序组成双向链表，每个桶内是一条 LRU 链表。
+// 命中时对象移到相邻的“次数 + 1”桶（不存在则在后面新建），淘汰最小次数桶中最久未访问的对象。
+// 对象和桶都从构造时分配好的池中取，链接用下标，运行期不分配内存（哈希表除外）
+//
+// 可选动态老化（LFU-DA）：淘汰时把老化值 L 推进到被淘汰对象的优先级，新对象以 L + 1 进入，
+// 使过去很热、现在不再访问的对象最终被新对象超过。为保持 O(1)，命中时优先级只加一，
+// 而不是按当前的 L 重新计算（原始 LFU-DA 为 L + 次数，需要堆）
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class LFUCache {
+public:
+    explicit LFUCache(int c, std::string file_name, bool dynamic_aging = false);
+
+    LFUCache(const LFUCache&) = delete;
+    LFUCache& operator=(const LFUCache&) = delete;
+
+    bool get(int target);
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _table.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    bool contains(int target) const { return _table.find(target) != _table.end(); }
+    // 缓存已满时下一次未命中将淘汰的对象，否则 -1
+    int victim() const;
+    bool erase(int target);
+    // 驻留对象按淘汰先后追加到 out：优先级从低到高，同一桶内从最久未访问的开始
+    void residents(std::vector<int>& out) const;
+    // 非空时把每个被淘汰的对象追加到 log（erase 不算淘汰），多级缓存独占模式按它降级
+    void set_eviction_log(std::vector<int>* log) { _eviction_log = log; }
+
+private:
+    static const uint32_t kNil = 0xffffffffu;
+
+    struct entry {
+        int target;
+        uint32_t prev;    // 同一桶内更近访问的一侧
+        uint32_t next;
+        uint32_t bucket;
+    };
+    struct bucket {
+        uint64_t priority;  // 未开启老化时即访问次数
+        uint32_t prev;
+        uint32_t next;
+        uint32_t head;      // 最近访问
+        uint32_t tail;      // 最久未访问
+    };
+
+    uint32_t new_bucket(uint64_t priority, uint32_t after);
+    void free_bucket(uint32_t b);
+    void push_front(uint32_t b, uint32_t e);
+    void unlink(uint32_t e);
+    // 取出对象后桶为空则回收桶
+    void remove(uint32_t e);
+    void evict();
+
+    int _capacity;
+    std::string _file_name;
+    bool _aging;
+    uint64_t _age;    // 老化值 L
+    std::vector<entry> _entries;
+    std::vector<bucket> _buckets;  // 非空桶最多 c 个，命中时可能临时多一个
+    std::vector<uint32_t> _free_entries;
+    std::vector<uint32_t> _free_buckets;
+    uint32_t _first;  // 优先级最小的桶
+    size_t _bucket_count;
+    std::unordered_map<int, uint32_t> _table;  // target -> 对象下标
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _eviction_count;
+    std::vector<int>* _eviction_log = nullptr;
+};
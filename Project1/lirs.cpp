@@ -0,0 +1,221 @@
+#include "lirs.h"
+#include <algorithm>
+#include <sstream>
+
+LIRSCache::LIRSCache(int c, std::string file_name) :
+    _capacity(std::max(0, c)),
+    _lir_capacity(static_cast<size_t>(_capacity) - std::min<size_t>(_capacity, std::max(1, _capacity / 100))),
+    _nonresident_capacity(static_cast<size_t>(_capacity)),
+    _file_name(file_name),
+    _nodes(static_cast<size_t>(_capacity) * 2),
+    _stack(_nodes), _queue(_nodes), _nonresident(_nodes),
+    _lir_count(0), _resident(0), _pruned(0), _hit_count(0), _get_count(0), _eviction_count(0) {
+    _free.reserve(_nodes.size());
+    for (size_t i = _nodes.size(); i > 0; --i) {
+        _free.push_back(static_cast<uint32_t>(i - 1));
+    }
+    _table.reserve(_nodes.size());
+}
+
+bool LIRSCache::get(int target) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    ++_get_count;
+    auto it = _table.find(target);
+    if (it == _table.end()) {
+        if (_resident == static_cast<size_t>(_capacity)) {
+            evict();
+        }
+        // 预热阶段（LIR 未满）直接成为 LIR 块，之后新块都从驻留 HIR 开始
+        uint32_t n = allocate(target, _lir_count < _lir_capacity ? LIR : HIR_RESIDENT);
+        ++_resident;
+        _stack.push_front(n);
+        _nodes[n].in_stack = true;
+        if (_nodes[n].status == LIR) {
+            ++_lir_count;
+        }
+        else {
+            _queue.push_front(n);
+        }
+        return false;
+    }
+
+    uint32_t n = it->second;
+    node& x = _nodes[n];
+    if (x.status == LIR) {
+        ++_hit_count;
+        bool bottom = _stack.back() == n;
+        _stack.move_to_front(n);
+        if (bottom) {
+            prune();
+        }
+        return true;
+    }
+    if (x.status == HIR_RESIDENT) {
+        ++_hit_count;
+        // 重用距离小于最老的 LIR 块时升为 LIR；LIR 不满（有块被 erase）时也直接升级，保证栈底是 LIR 块
+        if (x.in_stack || _lir_count < _lir_capacity) {
+            if (x.in_stack) {
+                _stack.move_to_front(n);
+            }
+            else {
+                _stack.push_front(n);
+                x.in_stack = true;
+            }
+            _queue.remove(n);
+            promote(n);
+        }
+        else {
+            _stack.push_front(n);
+            x.in_stack = true;
+            _queue.move_to_front(n);
+        }
+        return true;
+    }
+
+    // 非驻留 HIR 块仍在 S 中：重新载入并升为 LIR。先移出非驻留队列，避免淘汰时被丢弃
+    _nonresident.remove(n);
+    if (_resident == static_cast<size_t>(_capacity)) {
+        evict();
+    }
+    ++_resident;
+    _stack.move_to_front(n);
+    promote(n);
+    return false;
+}
+
+void LIRSCache::promote(uint32_t n) {
+    if (_lir_capacity == 0) {
+        _nodes[n].status = HIR_RESIDENT;
+        _queue.push_front(n);
+        return;
+    }
+    _nodes[n].status = LIR;
+    if (++_lir_count <= _lir_capacity) {
+        return;
+    }
+    uint32_t b = _stack.back();
+    _stack.remove(b);
+    _nodes[b].in_stack = false;
+    _nodes[b].status = HIR_RESIDENT;
+    _queue.push_front(b);
+    --_lir_count;
+    prune();
+}
+
+void LIRSCache::prune() {
+    while (!_stack.empty() && _nodes[_stack.back()].status != LIR) {
+        uint32_t n = _stack.back();
+        _stack.remove(n);
+        _nodes[n].in_stack = false;
+        if (_nodes[n].status == HIR_NONRESIDENT) {
+            _nonresident.remove(n);
+            release(n);
+        }
+        ++_pruned;
+    }
+}
+
+void LIRSCache::evict() {
+    uint32_t n = _queue.back();
+    _queue.remove(n);
+    --_resident;
+    ++_eviction_count;
+    if (_eviction_log) {
+        _eviction_log->push_back(_nodes[n].target);
+    }
+    if (!_nodes[n].in_stack) {
+        release(n);
+        return;
+    }
+    _nodes[n].status = HIR_NONRESIDENT;
+    _nonresident.push_front(n);
+    if (_nonresident.size() > _nonresident_capacity) {
+        forget_oldest();
+    }
+}
+
+// 栈底是 LIR 块，最早的非驻留块不会在栈底，直接从 S 中间摘除
+void LIRSCache::forget_oldest() {
+    uint32_t n = _nonresident.back();
+    _nonresident.remove(n);
+    _stack.remove(n);
+    release(n);
+}
+
+uint32_t LIRSCache::allocate(int target, state status) {
+    uint32_t n = _free.back();
+    _free.pop_back();
+    node& x = _nodes[n];
+    x.target = target;
+    x.status = status;
+    x.in_stack = false;
+    _table.emplace(target, n);
+    return n;
+}
+
+void LIRSCache::release(uint32_t n) {
+    _table.erase(_nodes[n].target);
+    _free.push_back(n);
+}
+
+bool LIRSCache::contains(int target) const {
+    auto it = _table.find(target);
+    return it != _table.end() && _nodes[it->second].status != HIR_NONRESIDENT;
+}
+
+int LIRSCache::victim() const {
+    if (_resident < static_cast<size_t>(_capacity) || _queue.empty()) {
+        return -1;
+    }
+    return _nodes[_queue.back()].target;
+}
+
+void LIRSCache::residents(std::vector<int>& out) const {
+    for (uint32_t n = _queue.back(); n != list_hook::kNil; n = _nodes[n].queue.prev) {
+        out.push_back(_nodes[n].target);
+    }
+    for (uint32_t n = _stack.back(); n != list_hook::kNil; n = _nodes[n].stack.prev) {
+        if (_nodes[n].status == LIR) {
+            out.push_back(_nodes[n].target);
+        }
+    }
+}
+
+bool LIRSCache::erase(int target) {
+    auto it = _table.find(target);
+    if (it == _table.end() || _nodes[it->second].status == HIR_NONRESIDENT) {
+        return false;
+    }
+    uint32_t n = it->second;
+    if (_nodes[n].status == LIR) {
+        --_lir_count;
+    }
+    else {
+        _queue.remove(n);
+    }
+    if (_nodes[n].in_stack) {
+        _stack.remove(n);
+    }
+    --_resident;
+    release(n);
+    prune();
+    return true;
+}
+
+std::string LIRSCache::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << " lirs_cache:"
+        << " cache_size:" << _capacity
+        << " request:" << _get_count
+        << " hit:" << _hit_count
+        << " miss:" << _get_count - _hit_count
+        << " hit_rate:" << (_get_count ? 1.0 * _hit_count / _get_count : 0.0)
+        << " lir:" << _lir_count
+        << " hir:" << _queue.size()
+        << " nonresident:" << _nonresident.size()
+        << " stack:" << _stack.size()
+        << " pruned:" << _pruned << std::endl;
+    return s.str();
+}
@@ -0,0 +1,75 @@
+#pragma once
+// LIRS（Low Inter-reference Recency Set）：按重用距离而不是最近访问时间区分冷热，
+// 对略大于缓存的循环访问和一次性扫描不敏感
+//   栈 S：LIR 块、驻留 HIR 块和非驻留 HIR 块（只有元数据）按最近访问排列，栈底始终是 LIR 块
+//   队列 Q：驻留 HIR 块，淘汰从 Q 尾部进行
+// 容量的 1%（至少 1 块）留给驻留 HIR 块，其余为 LIR 块。非驻留 HIR 元数据最多 c 条，
+// 超出时按变为非驻留的先后丢弃最早的一条，S 的大小因此不超过 2c
+// 所有节点来自构造时分配的对象池，S、Q 和非驻留队列都是以下标链接的侵入式链表
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "index_list.h"
+
+class LIRSCache {
+public:
+    explicit LIRSCache(int c, std::string file_name);
+
+    LIRSCache(const LIRSCache&) = delete;
+    LIRSCache& operator=(const LIRSCache&) = delete;
+
+    bool get(int target);
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _resident; }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    bool contains(int target) const;
+    // 缓存已满时下一次未命中将淘汰的对象（Q 尾部），否则 -1
+    int victim() const;
+    bool erase(int target);
+    // 驻留对象按淘汰先后追加到 out：先 Q 中的驻留 HIR 块（从尾部开始），再按栈从底到顶的 LIR 块
+    void residents(std::vector<int>& out) const;
+    // 非空时把每个被淘汰的对象追加到 log（erase 不算淘汰），多级缓存独占模式按它降级
+    void set_eviction_log(std::vector<int>* log) { _eviction_log = log; }
+
+private:
+    enum state : uint8_t { LIR, HIR_RESIDENT, HIR_NONRESIDENT };
+
+    struct node {
+        int target;
+        state status;
+        bool in_stack;
+        list_hook stack;  // S 中的位置
+        list_hook queue;  // 驻留时为 Q 中的位置，非驻留时为非驻留队列中的位置
+    };
+
+    uint32_t allocate(int target, state status);
+    void release(uint32_t n);
+    // 块成为 LIR，超出 LIR 容量时把栈底的 LIR 块降为驻留 HIR
+    void promote(uint32_t n);
+    // 弹出栈底的 HIR 块，直到栈底为 LIR 块；每个节点只会被弹出一次，均摊 O(1)
+    void prune();
+    void evict();
+    void forget_oldest();
+
+    int _capacity;
+    size_t _lir_capacity;
+    size_t _nonresident_capacity;
+    std::string _file_name;
+    std::vector<node> _nodes;
+    std::vector<uint32_t> _free;
+    index_list<node, &node::stack> _stack;
+    index_list<node, &node::queue> _queue;
+    index_list<node, &node::queue> _nonresident;
+    std::unordered_map<int, uint32_t> _table;  // target -> 节点下标（含非驻留块）
+    size_t _lir_count;
+    size_t _resident;
+    uint64_t _pruned;
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _eviction_count;
+    std::vector<int>* _eviction_log = nullptr;
+};
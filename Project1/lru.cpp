@@ -16,8 +16,12 @@ int LRUCache::get(int target) {
         // δ
         _miss_count++;  // δм
         if (_items.size() >= _capacity) {
+            if (_eviction_log) {
+                _eviction_log->push_back(_items.back().first);
+            }
             _table.erase(_items.back().first);
             _items.pop_back();
+            ++_eviction_count;
         }
         _items.emplace_front(target, target);
         _table[target] = _items.begin();
@@ -31,6 +35,29 @@ int LRUCache::get(int target) {
 
     ̭βĶ̭*/
 }
+bool LRUCache::contains(int target) const {
+    return _table.find(target) != _table.end();
+}
+int LRUCache::victim() const {
+    if (_items.empty() || _items.size() < _capacity) {
+        return -1;
+    }
+    return _items.back().first;
+}
+void LRUCache::residents(std::vector<int>& out) const {
+    for (auto it = _items.rbegin(); it != _items.rend(); ++it) {
+        out.push_back(it->first);
+    }
+}
+bool LRUCache::erase(int target) {
+    auto it = _table.find(target);
+    if (it == _table.end()) {
+        return false;
+    }
+    _items.erase(it->second);
+    _table.erase(it);
+    return true;
+}
 std::string LRUCache::statics() {
     std::stringstream s;
     s << "trace:" << _file_name << " lru_cache:"
@@ -40,4 +67,52 @@ std::string LRUCache::statics() {
         << " miss:" << _miss_count  // δд
         << " hit_rate:" << 1.0 * _hit_count / _get_count << std::endl;
     return s.str();
-}
\ No newline at end of file
+}
+void LRUCache::save(snapshot_writer& w) const {
+    w.begin("lru");
+    w.put<int32_t>(_capacity);
+    w.put<uint32_t>(_hit_count);
+    w.put<uint32_t>(_get_count);
+    w.put<uint32_t>(_eviction_count);
+    std::vector<int32_t> items;
+    items.reserve(_items.size() * 2);
+    for (const auto& item : _items) {
+        items.push_back(item.first);
+        items.push_back(item.second);
+    }
+    w.put_vector(items);
+}
+
+bool LRUCache::load(snapshot_reader& r) {
+    int32_t capacity = 0;
+    uint32_t hit = 0, get = 0, evicted = 0;
+    std::vector<int32_t> items;
+    if (!r.expect("lru") || !r.get(capacity) || !r.get(hit) || !r.get(get) || !r.get(evicted) ||
+        !r.get_vector(items) || capacity != _capacity || items.size() % 2 != 0 ||
+        items.size() / 2 > static_cast<size_t>(_capacity)) {
+        return false;
+    }
+    _items.clear();
+    _table.clear();
+    _table.reserve(items.size() / 2);
+    for (size_t i = 0; i < items.size(); i += 2) {
+        _items.emplace_back(items[i], items[i + 1]);
+        _table[items[i]] = std::prev(_items.end());
+    }
+    _hit_count = hit;
+    _get_count = get;
+    _miss_count = get - hit;
+    _eviction_count = evicted;
+    return true;
+}
+
+bool LRUCache::save(const std::string& path) const {
+    snapshot_writer w;
+    save(w);
+    return w.write_file(path);
+}
+
+bool LRUCache::load(const std::string& path) {
+    snapshot_reader r;
+    return r.read_file(path) && load(r);
+}
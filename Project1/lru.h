@@ -4,13 +4,17 @@
 #include <list>
 #include <sstream>
 #include <cstdint>
+#include <vector>
+#include "snapshot.h"
+#include "memory_resource.h"
 
 
 class LRUCache {
 
 public:
-    explicit LRUCache(int c, std::string file_name) :
-        _capacity(c), _file_name(file_name), _hit_count(0), _get_count(0) {}
+    explicit LRUCache(int c, std::string file_name, policy_allocator alloc = current_policy_allocator()) :
+        _resource(make_policy_resource(alloc)), _items(_resource.get()), _table(0, _resource.get()),
+        _capacity(c), _hit_count(0), _get_count(0), _eviction_count(0), _file_name(file_name) {}
 
     LRUCache(const LRUCache&) = delete;
     LRUCache& operator=(const  LRUCache&) = delete;
@@ -20,13 +24,38 @@ public:
 public:
     int get(int target);
     std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _items.size(); }
+    // 㣨ԤȽʱãݲ
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; _miss_count = 0; }
+    // ǷڻУ LRU ˳
+    bool contains(int target) const;
+    // һδʱ̭Ķ󣬻δʱ -1
+    int victim() const;
+    // Ƴ󣨶༶ռģʽ¶һ̭
+    bool erase(int target);
+    // פ̭Ⱥ׷ӵ outδʹõǰ
+    void residents(std::vector<int>& out) const;
+    // ǿʱÿ̭Ķ׷ӵ logerase ̭༶ռģʽ
+    void set_eviction_log(std::vector<int>* log) { _eviction_log = log; }
+    // գ LRU ˳򱣴 (target, cache_addr)ʱһؽϣ
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+    void save(snapshot_writer& w) const;
+    bool load(snapshot_reader& r);
 
 private:
-    std::list<std::pair<int, int>> _items; // (target, cache_addr) 
-    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> _table;//ϣ
+    using item_list = resource_list<std::pair<int, int>>;
+
+    std::unique_ptr<memory_resource> _resource;  // ͹ϣĽڵڴ
+    item_list _items; // (target, cache_addr) 
+    resource_map<int, item_list::iterator> _table;//ϣ
     int _capacity;
     int _miss_count;  // ӵδм
     unsigned int _hit_count;
     unsigned int _get_count;
+    unsigned int _eviction_count;
     std::string _file_name;
+    std::vector<int>* _eviction_log = nullptr;
 };
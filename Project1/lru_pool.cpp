@@ -0,0 +1,81 @@
+#include "lru_pool.h"
+#include <algorithm>
+#include <sstream>
+
+PoolLRUCache::PoolLRUCache(int c, std::string file_name) :
+    _capacity(std::max(0, c)), _file_name(file_name), _nodes(static_cast<size_t>(_capacity)), _items(_nodes),
+    _hit_count(0), _get_count(0), _eviction_count(0) {
+    _free.reserve(_nodes.size());
+    for (size_t i = _nodes.size(); i > 0; --i) {
+        _free.push_back(static_cast<uint32_t>(i - 1));
+    }
+    _table.reserve(_nodes.size());
+}
+
+bool PoolLRUCache::get(int target) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    ++_get_count;
+    auto it = _table.find(target);
+    if (it != _table.end()) {
+        ++_hit_count;
+        _items.move_to_front(it->second);
+        return true;
+    }
+    uint32_t n;
+    if (_free.empty()) {
+        // 已满：表尾节点淘汰后直接给新对象用
+        n = _items.back();
+        _items.remove(n);
+        _table.erase(_nodes[n].target);
+        ++_eviction_count;
+        if (_eviction_log) {
+            _eviction_log->push_back(_nodes[n].target);
+        }
+    }
+    else {
+        n = _free.back();
+        _free.pop_back();
+    }
+    _nodes[n].target = target;
+    _items.push_front(n);
+    _table.emplace(target, n);
+    return false;
+}
+
+int PoolLRUCache::victim() const {
+    if (!_free.empty() || _items.empty()) {
+        return -1;
+    }
+    return _nodes[_items.back()].target;
+}
+
+bool PoolLRUCache::erase(int target) {
+    auto it = _table.find(target);
+    if (it == _table.end()) {
+        return false;
+    }
+    uint32_t n = it->second;
+    _items.remove(n);
+    _table.erase(it);
+    _free.push_back(n);
+    return true;
+}
+
+void PoolLRUCache::residents(std::vector<int>& out) const {
+    for (uint32_t n = _items.back(); n != list_hook::kNil; n = _nodes[n].hook.prev) {
+        out.push_back(_nodes[n].target);
+    }
+}
+
+std::string PoolLRUCache::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << " lru_pool_cache:"
+        << " cache_size:" << _capacity
+        << " request:" << _get_count
+        << " hit:" << _hit_count
+        << " miss:" << _get_count - _hit_count
+        << " hit_rate:" << (_get_count ? 1.0 * _hit_count / _get_count : 0.0) << std::endl;
+    return s.str();
+}
@@ -0,0 +1,50 @@
+#pragma once
+// 对象池上的 LRU：与 LIRS 共用同一套节点设施。节点在构造时一次分配 c 个，
+// 链表是以下标链接的侵入式链表（index_list），淘汰时直接复用表尾节点，访问路径上链表不分配内存
+// 命中率与 lru 相同，用于对比 std::list 节点分配的开销
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "index_list.h"
+
+class PoolLRUCache {
+public:
+    explicit PoolLRUCache(int c, std::string file_name);
+
+    PoolLRUCache(const PoolLRUCache&) = delete;
+    PoolLRUCache& operator=(const PoolLRUCache&) = delete;
+
+    bool get(int target);
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _items.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    bool contains(int target) const { return _table.find(target) != _table.end(); }
+    // 缓存已满时下一次未命中将淘汰的对象（表尾），否则 -1
+    int victim() const;
+    bool erase(int target);
+    // 驻留对象按淘汰先后追加到 out（最久未使用的在前）
+    void residents(std::vector<int>& out) const;
+    // 非空时把每个被淘汰的对象追加到 log（erase 不算淘汰），多级缓存独占模式按它降级
+    void set_eviction_log(std::vector<int>* log) { _eviction_log = log; }
+
+private:
+    struct node {
+        int target;
+        list_hook hook;
+    };
+
+    int _capacity;
+    std::string _file_name;
+    std::vector<node> _nodes;
+    std::vector<uint32_t> _free;
+    index_list<node, &node::hook> _items;       // 表头为最近访问
+    std::unordered_map<int, uint32_t> _table;   // target -> 节点下标
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _eviction_count;
+    std::vector<int>* _eviction_log = nullptr;
+};
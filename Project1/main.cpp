@@ -1,139 +1,188 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include "arc.h"
-#include "lru.h"
-#include"TDC.h"
-#include"score.h"
-#include "TraceLine.h"
+#include <sstream>
 #include <vector>
-#include <chrono>
-#include"tiercache.h"
-#include <thread>
-#include"tdc2.h"
+#include "TraceLine.h"
+#include "bench.h"
+#include "hierarchy.h"
+#include "memory_resource.h"
+#include "opt.h"
+#include "policy.h"
+#include "selftest.h"
+#include "sim.h"
+#include "sweep.h"
+#include "trace_source.h"
+#include "trc.h"
 
 
 
-// 定义一个用于存储 trace_line 记录的容器
-std::vector<trace_line> trace_records;
 int main(int argc, char** argv) { // 第一个参数是
 
+    // 微基准测试模式，结果以 JSON 输出到标准输出
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        return run_bench(argc, argv);
+    }
+    // 自检模式，逐项输出失败的检查
+    if (argc >= 2 && std::string(argv[1]) == "--selftest") {
+        return run_selftest(argc, argv);
+    }
+    // 参数扫描模式，结果表输出到标准输出或 --out 指定的文件
+    if (argc >= 2 && std::string(argv[1]) == "--sweep") {
+        return run_sweep(argc, argv);
+    }
+    // 多级缓存模拟，输出各级命中情况和估计的访问延迟
+    if (argc >= 2 && std::string(argv[1]) == "--hierarchy") {
+        return run_hierarchy(argc, argv);
+    }
+    // 离线最优（Belady）命中率，作为其他策略的上界
+    if (argc >= 2 && std::string(argv[1]) == "--opt") {
+        return run_opt(argc, argv);
+    }
+    // 把 trace（文本、合成或 .trc）转换为压缩的 .trc 格式
+    if (argc == 4 && std::string(argv[1]) == "--convert") {
+        std::unique_ptr<TraceSource> in = open_trace(argv[2]);
+        std::string error;
+        if (!in) {
+            std::cerr << "can't not find trace_file" << std::endl;
+            return -1;
+        }
+        if (!write_trc(*in, argv[3], &error)) {
+            std::cerr << error << std::endl;
+            return -1;
+        }
+        return 0;
+    }
     std::cout << "=== Entering main ===" << std::endl;
     std::cout << "argc = " << argc << std::endl;
     for (int i = 0; i < argc; ++i) {
         std::cout << "argv[" << i << "] = " << argv[i] << std::endl;
     }
-    if (argc != 3) {
-        std::cerr << "usage: " << argv[0] << " <c> <trace_file>\n"
+    if (argc < 3 || argc % 2 == 0) {
+        std::cerr << "usage: " << argv[0] << " <c> <trace_file> [--policies p1,p2,...] [--latency N]\n"
+            << "                 [--window N | --window-time T] [--series out.csv|out.json]\n"
+            << "                 [--checkpoint file [--checkpoint-every L]] [--resume file] [--warmup N|P% [--warmup-threads T]]\n"
+            << "                 [--alloc malloc|pool|pool_huge]\n"
             << "       <c>           -- cache_size\n"
-            << "       <trace_file>  -- path of trace_file" << std::endl;
+            << "       <trace_file>  -- path of trace_file (text or .trc), or synth:<spec> for a generated trace\n"
+            << "       --policies    -- policies to run (default: lru,arc,score,tdc,tdc_sketch,wtinylfu_lru,wtinylfu_arc)\n"
+            << "       --latency     -- time one of every N get() calls (64 keeps overhead under 2%)\n"
+            << "       --window      -- snapshot per-policy counters every N requests\n"
+            << "       --window-time -- snapshot every T units of trace time\n"
+            << "       --series      -- export the windowed series (CSV, or JSON for *.json)\n"
+            << "       --checkpoint  -- save simulator state at the end (and every L lines); lru/arc/ceph_tier only\n"
+            << "       --resume      -- restore a checkpoint and continue the same trace after it\n"
+            << "       --warmup      -- fast-forward N requests (or P% of the trace) without statistics\n"
+            << "       --warmup-threads -- policies warmed in parallel (default: hardware threads)\n"
+            << "       --alloc       -- default allocator for policy containers: malloc (default), per-cache pool, or pool on huge pages\n"
+            << "   or: " << argv[0] << " --bench [options]  -- micro-benchmark every policy\n"
+            << "   or: " << argv[0] << " --sweep [options]  -- run a (trace, policy, cache size) grid in parallel\n"
+            << "   or: " << argv[0] << " --convert <trace> <out.trc>  -- write a compressed trace\n"
+            << "   or: " << argv[0] << " --hierarchy <trace> <spec> [options]  -- multi-tier latency estimate\n"
+            << "   or: " << argv[0] << " --selftest  -- check trace parsing and statistics" << std::endl;
         return 1;
     }
 
     int c = std::stoi(argv[1]);
-    FILE* pFile = nullptr;
-    if (fopen_s(&pFile, argv[2], "r") != 0) {
+    std::vector<std::string> names = default_policies();
+    SimOptions options;
+    std::string series_path;
+    std::string resume_path;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--policies") {
+            names.clear();
+            std::stringstream ss(argv[i + 1]);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                names.push_back(name);
+            }
+        }
+        else if (arg == "--latency") {
+            options.latency_sample = std::stoi(argv[i + 1]);
+        }
+        else if (arg == "--window") {
+            options.window_requests = std::stoull(argv[i + 1]);
+        }
+        else if (arg == "--window-time") {
+            options.window_time = static_cast<time_t>(std::stoll(argv[i + 1]));
+        }
+        else if (arg == "--series") {
+            series_path = argv[i + 1];
+        }
+        else if (arg == "--checkpoint") {
+            options.checkpoint_path = argv[i + 1];
+        }
+        else if (arg == "--checkpoint-every") {
+            options.checkpoint_every = std::stoull(argv[i + 1]);
+        }
+        else if (arg == "--warmup") {
+            // 以 % 结尾表示 trace 的比例，否则为请求数
+            std::string v = argv[i + 1];
+            if (!v.empty() && v.back() == '%') {
+                options.warmup_fraction = std::stod(v.substr(0, v.size() - 1)) / 100.0;
+            }
+            else {
+                options.warmup_requests = std::stoull(v);
+            }
+        }
+        else if (arg == "--warmup-threads") {
+            options.warmup_threads = std::stoi(argv[i + 1]);
+        }
+        else if (arg == "--resume") {
+            resume_path = argv[i + 1];
+        }
+        else if (arg == "--alloc") {
+            policy_allocator kind;
+            if (!parse_policy_allocator(argv[i + 1], &kind)) {
+                std::cerr << "unknown allocator: " << argv[i + 1] << std::endl;
+                return 1;
+            }
+            set_policy_allocator(kind);
+        }
+        else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    // 文件 trace 和合成 trace 走同一个模拟循环
+    std::unique_ptr<TraceSource> source = open_trace(argv[2]);
+    if (!source) {
         std::cerr << "can't not find trace_file" << std::endl;
         return -1;
     }
 
-    LRUCache lru_cache(c, argv[2]);
-    ARCCache arc_cache(c, argv[2]);
-    SCORECache score_cache(c, argv[2]);
-    TDCCache tdc_cache(c, argv[2]);
-    trace_line l;
-    int access_counter = 0;
-    // 在主循环中添加一个计数器
-    //int requestCounter = 0;
-    // 定义一个用于存储 trace_line 记录的容器
-    std::vector<trace_line> trace_records;
-    // 添加行计数器，用于进度输出
-    int line_count = 0;
-    // 记录程序开始时间，用于计算耗时
-    auto start_time = std::chrono::steady_clock::now();
-    //最外层的 while 循环用于从文件中读取 trace 数据。在每次迭代中，它读取一行数据，将这一行的信息存储在 trace_line 结构体中，并进行相应的处理。
-    //具体来说，每次迭代中，while 循环从文件中读取一个 trace 数据，该数据包括起始块、块数、忽略标志和请求号。这些信息被存储在 trace_line 结构体中的对应成员中。
-    while (fscanf_s(pFile, "%d %d %d %d\n",
-        &l.starting_block, &l.size_of_blocks, &l.ignore, &l.request_number) != EOF) {
-        line_count++;  // 每处理一行，计数器+1
-        // 更新每个 trace 数据的目前访问时间和最后访问时间戳
-        // 计算对象大小
-        int size = l.size_of_blocks * 4096;
-        l.current_time = time(nullptr);  // 使用系统当前时间
-        l.access_count = 0;  // 初始化访问次数为0
-        // 获取相应的数据
-        int n = 1; // 初始化周期计数器
-        int requestCounter = 0; // 请求计数器
-        //内部的 for 循环则对从文件中读取的每个 trace 数据进行缓存访问的模拟。在每次迭代中，它对当前 trace 数据中描述的块范围进行循环，调用 LRUCache 和 ARCCache 类的 get 方法来模拟从缓存中获取数据。
-        //在这个循环内，针对每个块，它执行了一些断言检查，确保缓存访问的正确性。
-        for (auto i = l.starting_block; i < (l.starting_block + l.size_of_blocks); ++i) {
-            // 增加计数器
-            
-            auto res1 = lru_cache.get(i);
-            assert(res1 != -1);
-            auto res2 = arc_cache.get(i);
-            assert(res2 != -1);
-
-            // SCORE算法相关代码
-            // 获取系统当前时间
-            auto getCurrentTime = []() {
-                return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()
-                ).count());
-            };
-            
-            // 创建一个新的 trace_line 对象
-            trace_line new_trace;
-            new_trace.starting_block = l.starting_block;
-            new_trace.size_of_blocks = l.size_of_blocks;
-            new_trace.ignore = l.ignore;
-            new_trace.request_number = l.request_number;
-            new_trace.access_count = l.access_count;
-            new_trace.current_time = getCurrentTime();
-            // 将新的 trace_line 对象添加到 trace_records 容器中
-            trace_records.push_back(new_trace);
-            SCOREParams scoreparam{ i, trace_records };
-            auto res3 = score_cache.get(scoreparam);
-            assert(res3 != -1);
-            // TDC算法相关代码
-            // 判断是否达到一个周期
-            if (requestCounter % 160000 == 0) {
-                ++n;
-            }
-            TDCParams tdcParams{ i, n, static_cast<double>(size) };//i对象 n是周期 size缓存大小
-            auto res4 = tdc_cache.get(tdcParams);
-            assert(res4 != -1);
-            requestCounter++;
-        }
-        
-        // 每100行输出一次进度信息和耗时信息，便于对比时间提升情况
-        if (line_count % 100 == 0) {
-            auto current_time = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time).count();
-            auto elapsed_minutes = elapsed / 60;
-            auto elapsed_seconds = elapsed % 60;
-            std::cout << "Processed " << line_count << " lines... "
-                      << "Elapsed time: " << elapsed_minutes << "m " << elapsed_seconds << "s\n";
-        }
-        
-        // 注释掉详细的每行输出，以提升性能
-        //std::cout << "Starting Block: " << l.starting_block << "\n"
-        //    << "Number of Blocks: " << l.size_of_blocks << "\n"
-        //    << "Ignore: " << l.ignore << "\n"
-        //    << "Request Number: " << l.request_number << "\n"
-        //    << "Current Access Time: " << l.current_time << "\n"
-        //    << "------------------------\n";
-
-        trace_records.push_back(l);
+    std::vector<std::unique_ptr<CachePolicy>> policies;
+    for (const auto& name : names) {
+        std::unique_ptr<CachePolicy> p = make_policy(name, c, argv[2]);
+        if (!p) {
+            std::cerr << "unknown policy: " << name << std::endl;
+            return 1;
+        }
+        policies.push_back(std::move(p));
     }
 
-    //std::unordered_map<int, TemperatureRecord> temperatureTable = lru_cache.calculateTemperature(trace_records);
-    // 打印温度表
+    Simulator sim(std::move(policies), options);
+    if (!resume_path.empty()) {
+        std::string error;
+        if (!sim.load_checkpoint(resume_path, &error)) {
+            std::cerr << "can't resume: " << error << std::endl;
+            return 1;
+        }
+        std::cout << "resumed at line " << sim.line_count() << std::endl;
+    }
+    sim.run(*source);
 
-    std::cout << lru_cache.statics();
-    std::cout << arc_cache.statics();
-    std::cout << score_cache.statics();
-    std::cout << tdc_cache.statics();
+    std::cout << sim.statics();
+    if (!series_path.empty()) {
+        if (sim.series().window_count() == 0) {
+            std::cerr << "--series needs --window or --window-time" << std::endl;
+        }
+        else if (!sim.series().write(series_path)) {
+            std::cerr << "can't write " << series_path << std::endl;
+            return 1;
+        }
+    }
     return 0;
 }
-
@@ -0,0 +1,143 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+mapped_file::mapped_file() :
+    _size(0), _view(nullptr), _view_bytes(0), _granularity(0), _file(INVALID_HANDLE_VALUE), _mapping(nullptr) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    _granularity = info.dwAllocationGranularity;
+}
+
+bool mapped_file::open(const std::string& path) {
+    close();
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size)) {
+        close();
+        return false;
+    }
+    _size = static_cast<uint64_t>(size.QuadPart);
+    // 空文件不能创建映射对象，map() 对空区间直接返回
+    if (_size > 0) {
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+const void* mapped_file::map(uint64_t offset, size_t bytes) {
+    unmap();
+    if (bytes == 0 || offset + bytes > _size) {
+        return nullptr;
+    }
+    uint64_t aligned = offset - offset % _granularity;
+    size_t skip = static_cast<size_t>(offset - aligned);
+    _view = MapViewOfFile(_mapping, FILE_MAP_READ, static_cast<DWORD>(aligned >> 32),
+        static_cast<DWORD>(aligned & 0xffffffffu), bytes + skip);
+    if (!_view) {
+        return nullptr;
+    }
+    _view_bytes = bytes + skip;
+    return static_cast<const char*>(_view) + skip;
+}
+
+void mapped_file::unmap() {
+    if (_view) {
+        UnmapViewOfFile(_view);
+        _view = nullptr;
+        _view_bytes = 0;
+    }
+}
+
+void mapped_file::close() {
+    unmap();
+    if (_mapping) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+    if (_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+    }
+    _size = 0;
+}
+
+#else
+
+mapped_file::mapped_file() :
+    _size(0), _view(nullptr), _view_bytes(0), _granularity(static_cast<size_t>(sysconf(_SC_PAGESIZE))), _fd(-1) {}
+
+bool mapped_file::open(const std::string& path) {
+    close();
+    _fd = ::open(path.c_str(), O_RDONLY);
+    if (_fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(_fd, &st) != 0) {
+        close();
+        return false;
+    }
+    _size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+const void* mapped_file::map(uint64_t offset, size_t bytes) {
+    unmap();
+    if (bytes == 0 || offset + bytes > _size) {
+        return nullptr;
+    }
+    uint64_t aligned = offset - offset % _granularity;
+    size_t skip = static_cast<size_t>(offset - aligned);
+    void* p = mmap(nullptr, bytes + skip, PROT_READ, MAP_PRIVATE, _fd, static_cast<off_t>(aligned));
+    if (p == MAP_FAILED) {
+        return nullptr;
+    }
+    madvise(p, bytes + skip, MADV_SEQUENTIAL);
+    _view = p;
+    _view_bytes = bytes + skip;
+    return static_cast<const char*>(p) + skip;
+}
+
+void mapped_file::unmap() {
+    if (_view) {
+        munmap(_view, _view_bytes);
+        _view = nullptr;
+        _view_bytes = 0;
+    }
+}
+
+void mapped_file::close() {
+    unmap();
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _size = 0;
+}
+
+#endif
+
+mapped_file::~mapped_file() {
+    close();
+}
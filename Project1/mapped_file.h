@@ -0,0 +1,35 @@
+#pragma once
+// 只读内存映射：按窗口映射大文件的一段，地址空间占用与文件大小无关
+// Windows 用 CreateFileMapping/MapViewOfFile，其他平台用 mmap
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class mapped_file {
+public:
+    mapped_file();
+    ~mapped_file();
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    bool open(const std::string& path);
+    uint64_t size() const { return _size; }
+    // 映射 [offset, offset + bytes)，返回指向 offset 处的指针，之前映射的窗口失效；失败返回 nullptr
+    const void* map(uint64_t offset, size_t bytes);
+    void close();
+
+private:
+    void unmap();
+
+    uint64_t _size;
+    void* _view;         // 按映射粒度对齐后的起始地址
+    size_t _view_bytes;
+    size_t _granularity;
+#ifdef _WIN32
+    void* _file;
+    void* _mapping;
+#else
+    int _fd;
+#endif
+};
@@ -0,0 +1,270 @@
+#include "memory_resource.h"
+#include "alloc_counter.h"
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+const size_t kHugePage = 2 * 1024 * 1024;
+const size_t kFirstChunk = 64 * 1024;
+const size_t kMaxChunk = 1024 * 1024;
+const size_t kMaxArenaBlock = 16 * 1024 * 1024;
+
+policy_allocator g_policy_allocator = policy_allocator::MALLOC;
+
+inline char* align_up(char* p, size_t alignment) {
+    uintptr_t v = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char*>((v + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
+
+// 申请 size 字节（2MB 的整数倍）并请求大页，失败返回 nullptr
+void* map_huge(size_t size) {
+#ifdef _WIN32
+    SIZE_T large = GetLargePageMinimum();
+    if (large == 0 || size % large != 0) {
+        return nullptr;
+    }
+    // 需要 SeLockMemoryPrivilege，没有权限时失败
+    return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+#else
+    // 多申请一页再裁掉首尾，保证起始地址按 2MB 对齐，整块都能由大页承载
+    size_t span = size + kHugePage;
+    void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    char* base = align_up(static_cast<char*>(raw), kHugePage);
+    size_t head = static_cast<size_t>(base - static_cast<char*>(raw));
+    if (head) {
+        munmap(raw, head);
+    }
+    if (span - head > size) {
+        munmap(base + size, span - head - size);
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(base, size, MADV_HUGEPAGE);
+#endif
+    return base;
+#endif
+}
+
+void unmap_huge(void* p, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+
+} // namespace
+
+// 全局 operator new 只保证 max_align_t 对齐，容器节点不需要更大的对齐
+void* heap_resource::do_allocate(size_t bytes, size_t) {
+    return ::operator new(bytes);
+}
+
+void heap_resource::do_deallocate(void* p, size_t, size_t) {
+    ::operator delete(p);
+}
+
+bool heap_resource::do_is_equal(const memory_resource& other) const {
+    return dynamic_cast<const heap_resource*>(&other) != nullptr;
+}
+
+memory_resource* new_delete_resource() {
+    static heap_resource resource;
+    return &resource;
+}
+
+const size_t pool_resource::kGranule;
+const size_t pool_resource::kMaxBlock;
+
+pool_resource::pool_resource(bool huge_pages, memory_resource* upstream) :
+    _upstream(upstream), _huge_pages(huge_pages), _cursor(nullptr), _end(nullptr),
+    _next_chunk(kFirstChunk), _reserved(0), _huge_chunks(0) {
+    std::fill(_free, _free + kMaxBlock / kGranule, nullptr);
+}
+
+pool_resource::~pool_resource() {
+    for (const chunk& c : _chunks) {
+        if (c.mapped) {
+            unmap_huge(c.base, c.size);
+            if (c.owner) {
+                c.owner->on_free(c.size);
+                mem_ledger_release(c.owner);
+            }
+        }
+        else {
+            _upstream->deallocate(c.base, c.size);
+        }
+    }
+}
+
+void* pool_resource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > kMaxBlock || alignment > kGranule) {
+        return _upstream->allocate(bytes, alignment);
+    }
+    size_t cls = bytes ? (bytes - 1) / kGranule : 0;
+    if (free_block* b = _free[cls]) {
+        _free[cls] = b->next;
+        return b;
+    }
+    size_t block = (cls + 1) * kGranule;
+    if (static_cast<size_t>(_end - _cursor) < block) {
+        refill(block);
+    }
+    void* p = _cursor;
+    _cursor += block;
+    return p;
+}
+
+void pool_resource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    if (bytes > kMaxBlock || alignment > kGranule) {
+        _upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+    size_t cls = bytes ? (bytes - 1) / kGranule : 0;
+    free_block* b = static_cast<free_block*>(p);
+    b->next = _free[cls];
+    _free[cls] = b;
+}
+
+void pool_resource::refill(size_t need) {
+    // 剩余部分不足一块，整段挂到能容纳的最大一档
+    size_t rest = static_cast<size_t>(_end - _cursor);
+    if (rest >= kGranule) {
+        size_t cls = rest / kGranule - 1;
+        free_block* b = reinterpret_cast<free_block*>(_cursor);
+        b->next = _free[cls];
+        _free[cls] = b;
+    }
+
+    chunk c;
+    c.base = nullptr;
+    c.mapped = false;
+    c.owner = nullptr;
+    if (_huge_pages) {
+        c.size = kHugePage;
+        c.base = map_huge(c.size);
+        if (c.base) {
+            // 不经过 operator new，手工记到当前账户上
+            c.mapped = true;
+            c.owner = mem_ledger_acquire(current_mem_ledger());
+            if (c.owner) {
+                c.owner->on_alloc(c.size);
+            }
+            ++_huge_chunks;
+        }
+    }
+    if (!c.base) {
+        c.size = std::max(_next_chunk, need);
+        c.base = _upstream->allocate(c.size);
+        // 大块从 64KB 开始倍增到 1MB，小缓存不会一次占用太多
+        _next_chunk = std::min(_next_chunk * 2, kMaxChunk);
+    }
+    _chunks.push_back(c);
+    _reserved += c.size;
+    _cursor = static_cast<char*>(c.base);
+    _end = _cursor + c.size;
+}
+
+monotonic_resource::monotonic_resource(size_t initial, memory_resource* upstream) :
+    _upstream(upstream), _cursor(nullptr), _end(nullptr), _next_size(std::max<size_t>(initial, 1024)), _reserved(0) {}
+
+monotonic_resource::~monotonic_resource() {
+    for (const block& b : _blocks) {
+        _upstream->deallocate(b.base, b.size);
+    }
+}
+
+void* monotonic_resource::do_allocate(size_t bytes, size_t alignment) {
+    char* p = align_up(_cursor, alignment);
+    if (!_cursor || p + bytes > _end) {
+        block b;
+        b.size = std::max(_next_size, bytes + alignment);
+        b.base = _upstream->allocate(b.size);
+        _blocks.push_back(b);
+        _reserved += b.size;
+        _next_size = std::min(_next_size * 2, kMaxArenaBlock);
+        _cursor = static_cast<char*>(b.base);
+        _end = _cursor + b.size;
+        p = align_up(_cursor, alignment);
+    }
+    _cursor = p + bytes;
+    return p;
+}
+
+void monotonic_resource::reset() {
+    if (_blocks.size() <= 1) {
+        _cursor = _blocks.empty() ? nullptr : static_cast<char*>(_blocks[0].base);
+        return;
+    }
+    auto largest = std::max_element(_blocks.begin(), _blocks.end(),
+        [](const block& a, const block& b) { return a.size < b.size; });
+    block keep = *largest;
+    for (const block& b : _blocks) {
+        if (b.base != keep.base) {
+            _upstream->deallocate(b.base, b.size);
+        }
+    }
+    _blocks.assign(1, keep);
+    _reserved = keep.size;
+    _cursor = static_cast<char*>(keep.base);
+    _end = _cursor + keep.size;
+}
+
+void set_policy_allocator(policy_allocator kind) {
+    g_policy_allocator = kind;
+}
+
+policy_allocator current_policy_allocator() {
+    return g_policy_allocator;
+}
+
+bool parse_policy_allocator(const std::string& name, policy_allocator* kind) {
+    if (name == "malloc") {
+        *kind = policy_allocator::MALLOC;
+    }
+    else if (name == "pool") {
+        *kind = policy_allocator::POOL;
+    }
+    else if (name == "pool_huge") {
+        *kind = policy_allocator::POOL_HUGE;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+const char* policy_allocator_name(policy_allocator kind) {
+    switch (kind) {
+    case policy_allocator::POOL:
+        return "pool";
+    case policy_allocator::POOL_HUGE:
+        return "pool_huge";
+    default:
+        return "malloc";
+    }
+}
+
+std::unique_ptr<memory_resource> make_policy_resource(policy_allocator kind) {
+    switch (kind) {
+    case policy_allocator::POOL:
+        return std::unique_ptr<memory_resource>(new pool_resource(false));
+    case policy_allocator::POOL_HUGE:
+        return std::unique_ptr<memory_resource>(new pool_resource(true));
+    default:
+        return std::unique_ptr<memory_resource>(new heap_resource());
+    }
+}
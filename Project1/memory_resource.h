@@ -0,0 +1,183 @@
+#pragma once
+// 策略容器的内存来源。工程按 C++14 编译，没有 std::pmr，这里按同样的接口实现一个最小版本：
+//   memory_resource      抽象基类（allocate / deallocate / is_equal）
+//   heap_resource        直接用 operator new/delete
+//   pool_resource        定长块池：按 16 字节分档的空闲链表，块从大块内存中切出，用于链表/哈希表节点
+//   monotonic_resource   单调增长的暂存区：deallocate 不做事，reset() 一次性回收，用于每次淘汰的临时表
+//   resource_allocator   把 memory_resource 包装成标准分配器，供 std::list / std::unordered_map 等使用
+// 使用哪种分配器可以在 make_policy 中按策略指定，缓存类的构造参数 alloc 默认取本次运行的选择
+// （--alloc malloc|pool|pool_huge）。每个缓存对象持有自己的资源，
+// 资源不加锁，只能在同一时刻由一个线程使用
+// 缓存类把持有资源的 unique_ptr 成员声明在使用它的容器之前：成员按声明顺序构造、逆序析构，
+// 资源先于容器建立、晚于容器释放
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct mem_ledger;
+
+class memory_resource {
+public:
+    virtual ~memory_resource() {}
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        return do_allocate(bytes, alignment);
+    }
+    void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        do_deallocate(p, bytes, alignment);
+    }
+    bool is_equal(const memory_resource& other) const { return do_is_equal(other); }
+
+private:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const memory_resource& other) const { return this == &other; }
+};
+
+class heap_resource : public memory_resource {
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const memory_resource& other) const override;
+};
+
+// 全局共享的 heap_resource
+memory_resource* new_delete_resource();
+
+class pool_resource : public memory_resource {
+public:
+    // huge_pages 为 true 时大块内存按 2MB 对齐申请并请求透明大页（Linux madvise / Windows 大页），
+    // 申请失败时退回普通内存
+    explicit pool_resource(bool huge_pages = false, memory_resource* upstream = new_delete_resource());
+    ~pool_resource();
+
+    pool_resource(const pool_resource&) = delete;
+    pool_resource& operator=(const pool_resource&) = delete;
+
+    static const size_t kGranule = 16;
+    static const size_t kMaxBlock = 512;   // 更大的请求直接交给 upstream
+
+    size_t chunk_count() const { return _chunks.size(); }
+    size_t reserved_bytes() const { return _reserved; }
+    size_t huge_chunks() const { return _huge_chunks; }
+
+private:
+    struct chunk {
+        void* base;
+        size_t size;
+        bool mapped;            // 通过 mmap / VirtualAlloc 申请
+        mem_ledger* owner;      // mapped 时手工记账的账户，持有一个引用
+    };
+    struct free_block {
+        free_block* next;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    // 申请新的大块内存，当前大块剩余部分按最大档挂到空闲链表
+    void refill(size_t need);
+
+    memory_resource* _upstream;
+    bool _huge_pages;
+    free_block* _free[kMaxBlock / kGranule];
+    char* _cursor;
+    char* _end;
+    size_t _next_chunk;
+    size_t _reserved;
+    size_t _huge_chunks;
+    std::vector<chunk> _chunks;
+};
+
+class monotonic_resource : public memory_resource {
+public:
+    explicit monotonic_resource(size_t initial = 64 * 1024, memory_resource* upstream = new_delete_resource());
+    ~monotonic_resource();
+
+    monotonic_resource(const monotonic_resource&) = delete;
+    monotonic_resource& operator=(const monotonic_resource&) = delete;
+
+    // 回收全部内存，只保留最大的一块供下一轮使用；调用前所有从这里分配的对象必须已经析构
+    void reset();
+    size_t reserved_bytes() const { return _reserved; }
+
+private:
+    struct block {
+        void* base;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    memory_resource* _upstream;
+    std::vector<block> _blocks;
+    char* _cursor;
+    char* _end;
+    size_t _next_size;
+    size_t _reserved;
+};
+
+template <class T>
+class resource_allocator {
+public:
+    using value_type = T;
+
+    resource_allocator() : _resource(new_delete_resource()) {}
+    resource_allocator(memory_resource* r) : _resource(r ? r : new_delete_resource()) {}
+    template <class U>
+    resource_allocator(const resource_allocator<U>& other) : _resource(other.resource()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        _resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    memory_resource* resource() const { return _resource; }
+
+    // 容器拷贝、赋值、交换时分配器不跟随，与 std::pmr::polymorphic_allocator 一致
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    resource_allocator select_on_container_copy_construction() const { return resource_allocator(); }
+
+private:
+    memory_resource* _resource;
+};
+
+template <class T, class U>
+bool operator==(const resource_allocator<T>& a, const resource_allocator<U>& b) {
+    return a.resource() == b.resource() || a.resource()->is_equal(*b.resource());
+}
+template <class T, class U>
+bool operator!=(const resource_allocator<T>& a, const resource_allocator<U>& b) {
+    return !(a == b);
+}
+
+template <class T>
+using resource_list = std::list<T, resource_allocator<T>>;
+template <class K, class V>
+using resource_map = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, resource_allocator<std::pair<const K, V>>>;
+
+// 策略容器使用的分配器
+enum class policy_allocator {
+    MALLOC,     // 全局 operator new（默认）
+    POOL,       // 每个缓存一个 pool_resource
+    POOL_HUGE,  // 同上，大块内存使用透明大页
+};
+
+// 本次运行的默认分配器，make_policy 未指定时使用
+void set_policy_allocator(policy_allocator kind);
+policy_allocator current_policy_allocator();
+// "malloc" / "pool" / "pool_huge"，无法识别时返回 false
+bool parse_policy_allocator(const std::string& name, policy_allocator* kind);
+const char* policy_allocator_name(policy_allocator kind);
+// 为一个缓存对象创建 kind 类型的资源
+std::unique_ptr<memory_resource> make_policy_resource(policy_allocator kind);
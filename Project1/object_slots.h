@@ -0,0 +1,140 @@
+#pragma once
+// Ceph 分层缓存（ceph_tier、tdc2）的对象存储：对象按槽位存放在并列数组中（SoA），oid -> 槽位用哈希表。
+// 删除时用最后一个槽位填补空位，数组始终紧凑，所以淘汰候选既可以 O(1) 均匀随机抽样，
+// 也可以从游标开始在连续内存上顺序扫描；候选的元数据再按列复制到 candidate_batch 中打分
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 选取淘汰候选的方式
+enum class candidate_mode {
+    SWEEP,    // 从游标开始取连续的槽位，游标随之前进，扫完一圈回到开头
+    RANDOM,   // 均匀随机抽样，同一批内可能重复
+};
+
+class object_slots {
+public:
+    std::vector<int32_t> oid;
+    std::vector<int32_t> size;
+    std::vector<int64_t> mtime;   // 插入时间：ceph_tier 为 system_clock 的 tick 数，tdc2 为访问序号
+
+    object_slots() : _cursor(0), _rng(0x2545f4914f6cdd1dULL) {}
+
+    size_t count() const { return oid.size(); }
+    bool empty() const { return oid.empty(); }
+    bool contains(int32_t key) const { return _index.find(key) != _index.end(); }
+    // 槽位，不存在时返回 -1
+    int64_t find(int32_t key) const {
+        auto it = _index.find(key);
+        return it == _index.end() ? -1 : static_cast<int64_t>(it->second);
+    }
+
+    void insert(int32_t key, int32_t object_size, int64_t object_mtime) {
+        _index.emplace(key, static_cast<uint32_t>(oid.size()));
+        oid.push_back(key);
+        size.push_back(object_size);
+        mtime.push_back(object_mtime);
+    }
+
+    // 删除槽位 s，原来的最后一个槽位移到 s
+    void remove(uint32_t s) {
+        _index.erase(oid[s]);
+        size_t last = oid.size() - 1;
+        if (s != last) {
+            oid[s] = oid[last];
+            size[s] = size[last];
+            mtime[s] = mtime[last];
+            _index[oid[s]] = s;
+        }
+        oid.pop_back();
+        size.pop_back();
+        mtime.pop_back();
+    }
+
+    void clear() {
+        oid.clear();
+        size.clear();
+        mtime.clear();
+        _index.clear();
+        _cursor = 0;
+    }
+
+    // 选出最多 n 个候选槽位写入 out，返回个数；顺序扫描时不超过对象数
+    size_t select(candidate_mode mode, size_t n, uint32_t* out) {
+        size_t total = oid.size();
+        if (total == 0) {
+            return 0;
+        }
+        if (mode == candidate_mode::RANDOM) {
+            for (size_t i = 0; i < n; ++i) {
+                // xorshift64，乘法取高位映射到 [0, total)
+                _rng ^= _rng << 13;
+                _rng ^= _rng >> 7;
+                _rng ^= _rng << 17;
+                out[i] = static_cast<uint32_t>(((_rng >> 32) * total) >> 32);
+            }
+            return n;
+        }
+        n = std::min(n, total);
+        if (_cursor >= total) {
+            _cursor = 0;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<uint32_t>(_cursor);
+            if (++_cursor == total) {
+                _cursor = 0;
+            }
+        }
+        return n;
+    }
+
+    size_t cursor() const { return _cursor; }
+    void set_cursor(size_t c) { _cursor = c < oid.size() ? c : 0; }
+
+private:
+    std::unordered_map<int32_t, uint32_t> _index;
+    size_t _cursor;
+    uint64_t _rng;
+};
+
+// 一批淘汰候选，按列存放：先按槽位把元数据复制过来，之后的打分循环只访问连续内存。
+// 淘汰会移动槽位，所以淘汰时按 oid 重新查找，不直接用 slot
+struct candidate_batch {
+    std::vector<uint32_t> slot;
+    std::vector<int32_t> oid;
+    std::vector<int32_t> size;
+    std::vector<int64_t> mtime;
+    std::vector<uint8_t> hit_bits;   // 第 0 位：在当前 hit set 中；第 i 位：在往前第 i 个历史 hit set 中
+    std::vector<int32_t> temp;
+    // 打分用的暂存列（tdc2）：年龄、密度、是否淘汰
+    std::vector<int32_t> age;
+    std::vector<float> density;
+    std::vector<uint8_t> mask;
+    size_t count = 0;
+
+    void resize(size_t n) {
+        count = n;
+        if (slot.size() < n) {
+            slot.resize(n);
+            oid.resize(n);
+            size.resize(n);
+            mtime.resize(n);
+            hit_bits.resize(n);
+            temp.resize(n);
+            age.resize(n);
+            density.resize(n);
+            mask.resize(n);
+        }
+    }
+
+    void gather(const object_slots& objects) {
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t s = slot[i];
+            oid[i] = objects.oid[s];
+            size[i] = objects.size[s];
+            mtime[i] = objects.mtime[s];
+        }
+    }
+};
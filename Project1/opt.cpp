@@ -0,0 +1,294 @@
+#include "opt.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include "mapped_file.h"
+
+namespace {
+
+const uint64_t kNever = UINT64_MAX;  // 之后不再访问
+const double kBlockBytes = 4096;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+OptOracle::OptOracle(const std::string& scratch_prefix, bool size_aware, size_t chunk_records) :
+    _access_path(scratch_prefix + ".acc"), _next_path(scratch_prefix + ".next"), _size_aware(size_aware),
+    _chunk_records(std::max<size_t>(1, chunk_records)), _accesses(0), _distinct(0) {}
+
+OptOracle::~OptOracle() {
+    std::remove(_access_path.c_str());
+    std::remove(_next_path.c_str());
+}
+
+bool OptOracle::prepare(TraceSource& source, std::string* error) {
+    return decode(source, error) && link_next_uses(error);
+}
+
+bool OptOracle::decode(TraceSource& source, std::string* error) {
+    FILE* out = nullptr;
+    if (fopen_s(&out, _access_path.c_str(), "wb") != 0 || !out) {
+        *error = "can't create " + _access_path;
+        return false;
+    }
+    std::vector<opt_access> buf;
+    buf.reserve(_chunk_records);
+    bool ok = true;
+    auto flush = [&]() {
+        ok = ok && fwrite(buf.data(), sizeof(opt_access), buf.size(), out) == buf.size();
+        buf.clear();
+    };
+    _accesses = 0;
+    trace_line l;
+    while (source.next(l)) {
+        if (_size_aware) {
+            buf.push_back(opt_access{ l.starting_block, static_cast<uint32_t>(std::max(1, l.size_of_blocks)) });
+        }
+        else {
+            for (int i = 0; i < l.size_of_blocks; ++i) {
+                buf.push_back(opt_access{ l.starting_block + i, 1 });
+                if (buf.size() == _chunk_records) {
+                    _accesses += buf.size();
+                    flush();
+                }
+            }
+        }
+        if (buf.size() >= _chunk_records) {
+            _accesses += buf.size();
+            flush();
+        }
+    }
+    _accesses += buf.size();
+    flush();
+    ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        *error = "write failed: " + _access_path;
+    }
+    return ok;
+}
+
+// 从后往前处理每一块：块内也从后往前，last 中保存每个对象在已处理部分中最早出现的位置，
+// 正好是当前访问的下一次使用位置。结果按块写回对应偏移，文件中的空洞由后写的块填满
+bool OptOracle::link_next_uses(std::string* error) {
+    mapped_file in;
+    FILE* out = nullptr;
+    if (!in.open(_access_path)) {
+        *error = "can't map " + _access_path;
+        return false;
+    }
+    if (fopen_s(&out, _next_path.c_str(), "wb") != 0 || !out) {
+        *error = "can't create " + _next_path;
+        return false;
+    }
+    std::unordered_map<int32_t, uint64_t> last;
+    std::vector<uint64_t> next;
+    bool ok = true;
+    uint64_t chunks = (_accesses + _chunk_records - 1) / _chunk_records;
+    for (uint64_t k = chunks; k-- > 0 && ok;) {
+        uint64_t first = k * _chunk_records;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(_chunk_records, _accesses - first));
+        const opt_access* acc = static_cast<const opt_access*>(
+            in.map(first * sizeof(opt_access), n * sizeof(opt_access)));
+        if (!acc) {
+            *error = "can't map " + _access_path;
+            ok = false;
+            break;
+        }
+        next.resize(n);
+        for (size_t i = n; i-- > 0;) {
+            auto it = last.find(acc[i].key);
+            if (it == last.end()) {
+                next[i] = kNever;
+                last.emplace(acc[i].key, first + i);
+            }
+            else {
+                next[i] = it->second;
+                it->second = first + i;
+            }
+        }
+        ok = file_seek64(out, first * sizeof(uint64_t)) == 0
+            && fwrite(next.data(), sizeof(uint64_t), n, out) == n;
+        if (!ok) {
+            *error = "write failed: " + _next_path;
+        }
+    }
+    _distinct = last.size();
+    ok = fclose(out) == 0 && ok;
+    return ok;
+}
+
+bool OptOracle::simulate(int c, opt_result* result, std::string* error) const {
+    *result = opt_result();
+    result->cache_size = c;
+    mapped_file acc_file;
+    mapped_file next_file;
+    if (_accesses > 0 && (!acc_file.open(_access_path) || !next_file.open(_next_path))) {
+        *error = "can't map scratch files";
+        return false;
+    }
+
+    struct cached {
+        uint64_t next;
+        uint32_t size;
+    };
+    typedef std::pair<uint64_t, int32_t> heap_item;  // (下一次使用位置, 对象)
+    std::unordered_map<int32_t, cached> cache;
+    std::vector<heap_item> heap;
+    uint64_t used = 0;
+    uint64_t capacity = static_cast<uint64_t>(std::max(0, c));
+    cache.reserve(static_cast<size_t>(std::min<uint64_t>(capacity, _distinct)));
+
+    for (uint64_t first = 0; first < _accesses; first += _chunk_records) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(_chunk_records, _accesses - first));
+        const opt_access* acc = static_cast<const opt_access*>(
+            acc_file.map(first * sizeof(opt_access), n * sizeof(opt_access)));
+        const uint64_t* next = static_cast<const uint64_t*>(
+            next_file.map(first * sizeof(uint64_t), n * sizeof(uint64_t)));
+        if (!acc || !next) {
+            *error = "can't map scratch files";
+            return false;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            // 命中会留下过期的堆项，堆超过缓存对象数的两倍时按缓存内容重建
+            if (heap.size() > 2 * cache.size() + 1024) {
+                heap.clear();
+                for (const auto& e : cache) {
+                    heap.push_back(heap_item(e.second.next, e.first));
+                }
+                std::make_heap(heap.begin(), heap.end());
+            }
+            int32_t key = acc[i].key;
+            uint32_t size = acc[i].size;
+            double bytes = size * kBlockBytes;
+            ++result->requests;
+            result->bytes_requested += bytes;
+            auto it = cache.find(key);
+            if (it != cache.end()) {
+                if (it->second.size >= size) {
+                    ++result->hits;
+                    result->bytes_hit += bytes;
+                    it->second.next = next[i];
+                    heap.push_back(heap_item(next[i], key));
+                    std::push_heap(heap.begin(), heap.end());
+                    continue;
+                }
+                // 同一起始块、更长的请求按未命中处理，用新长度替换旧对象
+                used -= it->second.size;
+                cache.erase(it);
+            }
+            if (size > capacity) {
+                continue;
+            }
+            cache[key] = cached{ next[i], size };
+            used += size;
+            heap.push_back(heap_item(next[i], key));
+            std::push_heap(heap.begin(), heap.end());
+            while (used > capacity) {
+                heap_item top = heap.front();
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+                auto victim = cache.find(top.second);
+                if (victim == cache.end() || victim->second.next != top.first) {
+                    continue;  // 过期的堆项
+                }
+                used -= victim->second.size;
+                cache.erase(victim);
+                if (top.second != key) {
+                    ++result->evictions;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+namespace {
+
+std::vector<int> parse_sizes(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            out.push_back(std::atoi(item.c_str()));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int run_opt(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0] << " --opt <trace> <c1,c2,...> [--size-aware] [--scratch prefix] [--chunk N]\n"
+            << "       --size-aware -- each trace line is one object of size_of_blocks blocks, capacity in blocks\n"
+            << "       --scratch    -- prefix of the two scratch files (default: opt_scratch)\n"
+            << "       --chunk      -- accesses mapped per chunk (default: 4194304)" << std::endl;
+        return 1;
+    }
+    std::string trace = argv[2];
+    std::vector<int> sizes = parse_sizes(argv[3]);
+    bool size_aware = false;
+    std::string scratch = "opt_scratch";
+    size_t chunk = 1 << 22;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--size-aware") {
+            size_aware = true;
+        }
+        else if (arg == "--scratch" && i + 1 < argc) {
+            scratch = argv[++i];
+        }
+        else if (arg == "--chunk" && i + 1 < argc) {
+            chunk = static_cast<size_t>(std::stoull(argv[++i]));
+        }
+        else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        std::cerr << "no cache sizes given" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<TraceSource> source = open_trace(trace);
+    if (!source) {
+        std::cerr << "can't not find trace_file" << std::endl;
+        return -1;
+    }
+    OptOracle oracle(scratch, size_aware, chunk);
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    if (!oracle.prepare(*source, &error)) {
+        std::cerr << error << std::endl;
+        return -1;
+    }
+    std::cout << "opt: accesses:" << oracle.access_count() << " objects:" << oracle.distinct_objects()
+        << " prepare_s:" << seconds_since(start) << std::endl;
+    for (int c : sizes) {
+        opt_result r;
+        start = std::chrono::steady_clock::now();
+        if (!oracle.simulate(c, &r, &error)) {
+            std::cerr << error << std::endl;
+            return -1;
+        }
+        std::cout << "trace:" << trace << (size_aware ? " opt_size_cache:" : " opt_cache:")
+            << " cache_size:" << c
+            << " request:" << r.requests
+            << " hit:" << r.hits
+            << " miss:" << r.requests - r.hits
+            << " hit_rate:" << (r.requests ? 1.0 * r.hits / r.requests : 0.0)
+            << " byte_hit_rate:" << (r.bytes_requested > 0 ? r.bytes_hit / r.bytes_requested : 0.0)
+            << " eviction:" << r.evictions
+            << " simulate_s:" << seconds_since(start) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+// 离线最优策略（Belady / OPT）：给出同一 trace 上命中率的上界，用来衡量 LRU、ARC、SCORE、TDC 离最优还差多少
+//   SCORE.exe --opt <trace> <c1,c2,...> [--size-aware] [--scratch 前缀] [--chunk N]
+//
+// 分三遍处理，内存只与不同对象数和缓存大小有关，与 trace 长度无关：
+//   1. 顺序解码 trace，把访问序列（对象号、大小）写入暂存文件 <前缀>.acc
+//   2. 从文件尾向前按块映射访问序列，用“对象 -> 最近一次出现的位置”哈希表一遍得到每次访问的下一次使用位置，
+//      按块写入 <前缀>.next
+//   3. 对每个缓存大小按块映射两个文件顺序模拟：淘汰下一次使用最远的对象（按下一次使用位置的最大堆，
+//      过期的堆项在弹出时丢弃）。新对象本身也参与比较，即允许不缓存（bypass），结果是命中率的上界
+// 默认每个块是一个对象，容量按对象数计，与其他策略一致。
+// --size-aware：trace 的每一行（按 starting_block 识别）是一个对象，大小为 size_of_blocks 块，容量按块计。
+//   缓存中同一起始块的对象不短于本次请求即为命中。按最远下一次使用淘汰直到放得下，
+//   这是带大小时 Belady 的常用近似（精确解是 NP 难的），不是严格上界
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "trace_source.h"
+
+struct opt_access {
+    int32_t key;
+    uint32_t size;  // 块数
+};
+
+struct opt_result {
+    int cache_size = 0;
+    uint64_t requests = 0;
+    uint64_t hits = 0;
+    double bytes_requested = 0;
+    double bytes_hit = 0;
+    uint64_t evictions = 0;
+};
+
+class OptOracle {
+public:
+    // chunk_records：每次映射和处理的访问数
+    OptOracle(const std::string& scratch_prefix, bool size_aware, size_t chunk_records = 1 << 22);
+    // 删除暂存文件
+    ~OptOracle();
+
+    OptOracle(const OptOracle&) = delete;
+    OptOracle& operator=(const OptOracle&) = delete;
+
+    // 第 1、2 遍：解码 trace 并计算下一次使用位置
+    bool prepare(TraceSource& source, std::string* error);
+    // 第 3 遍：容量为 c（对象数，或 --size-aware 时的块数）时的最优命中情况
+    bool simulate(int c, opt_result* result, std::string* error) const;
+    uint64_t access_count() const { return _accesses; }
+    uint64_t distinct_objects() const { return _distinct; }
+
+private:
+    bool decode(TraceSource& source, std::string* error);
+    bool link_next_uses(std::string* error);
+
+    std::string _access_path;
+    std::string _next_path;
+    bool _size_aware;
+    size_t _chunk_records;
+    uint64_t _accesses;
+    uint64_t _distinct;
+};
+
+int run_opt(int argc, char** argv);
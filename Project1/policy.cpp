@@ -0,0 +1,379 @@
+#include "policy.h"
+#include "alloc_counter.h"
+#include <type_traits>
+#include <utility>
+#include "lru.h"
+#include "lru_pool.h"
+#include "arc.h"
+#include "score.h"
+#include "TDC.h"
+#include "tiercache.h"
+#include "tdc2.h"
+#include "tinylfu.h"
+#include "gdsf.h"
+#include "s3fifo.h"
+#include "lfu.h"
+#include "lirs.h"
+#include "learned.h"
+#include "adaptive.h"
+
+namespace {
+
+// 支持快照的策略：LRU、ARC、Ceph 分层缓存
+template <class Cache>
+bool save_cache(const Cache&, snapshot_writer&) {
+    return false;
+}
+template <class Cache>
+bool load_cache(Cache&, snapshot_reader&) {
+    return false;
+}
+bool save_cache(const LRUCache& cache, snapshot_writer& w) {
+    cache.save(w);
+    return true;
+}
+bool load_cache(LRUCache& cache, snapshot_reader& r) {
+    return cache.load(r);
+}
+bool save_cache(const ARCCache& cache, snapshot_writer& w) {
+    cache.save(w);
+    return true;
+}
+bool load_cache(ARCCache& cache, snapshot_reader& r) {
+    return cache.load(r);
+}
+bool save_cache(const CephTierCache& cache, snapshot_writer& w) {
+    cache.save(w);
+    return true;
+}
+bool load_cache(CephTierCache& cache, snapshot_reader& r) {
+    return cache.load(r);
+}
+
+// 多级缓存独占模式需要的查询/移除操作，只有 LRU、ARC、GDSF、LFU、LIRS、对象池 LRU、Ceph 分层缓存实现
+template <class Cache>
+struct exclusive_ops {
+    static const bool value = false;
+};
+template <>
+struct exclusive_ops<LRUCache> {
+    static const bool value = true;
+};
+template <>
+struct exclusive_ops<ARCCache> {
+    static const bool value = true;
+};
+template <>
+struct exclusive_ops<CephTierCache> {
+    static const bool value = true;
+};
+template <>
+struct exclusive_ops<GDSFCache> {
+    static const bool value = true;
+};
+template <>
+struct exclusive_ops<LFUCache> {
+    static const bool value = true;
+};
+template <>
+struct exclusive_ops<LIRSCache> {
+    static const bool value = true;
+};
+template <>
+struct exclusive_ops<PoolLRUCache> {
+    static const bool value = true;
+};
+template <class Cache>
+bool contains_block(const Cache&, int) {
+    return false;
+}
+bool contains_block(const LRUCache& cache, int block) {
+    return cache.contains(block);
+}
+bool contains_block(const ARCCache& cache, int block) {
+    return cache.contains(block);
+}
+bool contains_block(const CephTierCache& cache, int block) {
+    return cache.contains(block);
+}
+bool contains_block(const GDSFCache& cache, int block) {
+    return cache.contains(block);
+}
+bool contains_block(const LFUCache& cache, int block) {
+    return cache.contains(block);
+}
+bool contains_block(const LIRSCache& cache, int block) {
+    return cache.contains(block);
+}
+bool contains_block(const PoolLRUCache& cache, int block) {
+    return cache.contains(block);
+}
+// Ceph 分层缓存由 agent 按温度淘汰，无法预知下一个淘汰对象
+template <class Cache>
+int victim_of(const Cache&) {
+    return -1;
+}
+int victim_of(const LRUCache& cache) {
+    return cache.victim();
+}
+int victim_of(const ARCCache& cache) {
+    return cache.victim();
+}
+int victim_of(const GDSFCache& cache) {
+    return cache.victim();
+}
+int victim_of(const LFUCache& cache) {
+    return cache.victim();
+}
+int victim_of(const LIRSCache& cache) {
+    return cache.victim();
+}
+int victim_of(const PoolLRUCache& cache) {
+    return cache.victim();
+}
+template <class Cache>
+bool erase_block(Cache&, int) {
+    return false;
+}
+bool erase_block(LRUCache& cache, int block) {
+    return cache.erase(block);
+}
+bool erase_block(ARCCache& cache, int block) {
+    return cache.erase(block);
+}
+bool erase_block(CephTierCache& cache, int block) {
+    return cache.erase(block);
+}
+bool erase_block(GDSFCache& cache, int block) {
+    return cache.erase(block);
+}
+bool erase_block(LFUCache& cache, int block) {
+    return cache.erase(block);
+}
+bool erase_block(LIRSCache& cache, int block) {
+    return cache.erase(block);
+}
+bool erase_block(PoolLRUCache& cache, int block) {
+    return cache.erase(block);
+}
+template <class Cache>
+void set_eviction_log_of(Cache&, std::vector<int>*) {}
+void set_eviction_log_of(LRUCache& cache, std::vector<int>* log) {
+    cache.set_eviction_log(log);
+}
+void set_eviction_log_of(ARCCache& cache, std::vector<int>* log) {
+    cache.set_eviction_log(log);
+}
+void set_eviction_log_of(GDSFCache& cache, std::vector<int>* log) {
+    cache.set_eviction_log(log);
+}
+void set_eviction_log_of(LFUCache& cache, std::vector<int>* log) {
+    cache.set_eviction_log(log);
+}
+void set_eviction_log_of(LIRSCache& cache, std::vector<int>* log) {
+    cache.set_eviction_log(log);
+}
+void set_eviction_log_of(PoolLRUCache& cache, std::vector<int>* log) {
+    cache.set_eviction_log(log);
+}
+template <class Cache>
+void residents_of(const Cache&, std::vector<int>&) {}
+void residents_of(const LRUCache& cache, std::vector<int>& out) {
+    cache.residents(out);
+}
+void residents_of(const ARCCache& cache, std::vector<int>& out) {
+    cache.residents(out);
+}
+void residents_of(const GDSFCache& cache, std::vector<int>& out) {
+    cache.residents(out);
+}
+void residents_of(const LFUCache& cache, std::vector<int>& out) {
+    cache.residents(out);
+}
+void residents_of(const LIRSCache& cache, std::vector<int>& out) {
+    cache.residents(out);
+}
+void residents_of(const PoolLRUCache& cache, std::vector<int>& out) {
+    cache.residents(out);
+}
+
+// 以块号直接访问的策略
+template <class Cache>
+void access(Cache& cache, int block, SimContext&) {
+    cache.get(block);
+}
+void access(SCORECache& cache, int block, SimContext& ctx) {
+    SCOREParams scoreparam{ block, ctx.trace_records };
+    cache.get(scoreparam);
+}
+void access(TDCCache& cache, int block, SimContext& ctx) {
+    TDCParams tdcParams{ block, ctx.period, ctx.size };
+    cache.get(tdcParams);
+}
+// Ceph 分层缓存以块为容量单位，每个块大小记为 1
+void access(CephTierCache& cache, int block, SimContext&) {
+    cache.get(block, 1);
+}
+void access(tdcCache& cache, int block, SimContext&) {
+    cache.get(block, 1);
+}
+void access(GDSFCache& cache, int block, SimContext& ctx) {
+    cache.get(block, ctx.size);
+}
+void access(LearnedCache& cache, int block, SimContext& ctx) {
+    cache.get(block, ctx.size, ctx.request_number);
+}
+
+template <class Cache>
+class PolicyAdapter : public CachePolicy {
+public:
+    // 策略对象本身及其后在 get() 中分配的所有堆内存都记到 _mem 上
+    template <class... Args>
+    explicit PolicyAdapter(const char* name, Args&&... args) : _name(name) {
+        mem_scope scope(&_mem);
+        _cache.reset(new Cache(std::forward<Args>(args)...));
+    }
+
+    const char* name() const override { return _name; }
+
+    bool get(int block, SimContext& ctx) override {
+        mem_scope scope(&_mem);
+        unsigned int hits = _cache->hit_count();
+        access(*_cache, block, ctx);
+        bool hit = _cache->hit_count() != hits;
+        ++_stats.requests;
+        if (hit) {
+            ++_stats.hits;
+        }
+        else {
+            _stats.miss_time_us += _cost.block_cost_us(ctx.size);
+        }
+        _tally.add(_stats, hit, ctx.size, ctx.last_block);
+        return hit;
+    }
+
+    // 循环在具体类型上展开，每行只有一次虚调用
+    void warm_line(int start, int count, SimContext& ctx) override {
+        mem_scope scope(&_mem);
+        Cache& cache = *_cache;
+        for (int i = start; i < start + count; ++i) {
+            access(cache, i, ctx);
+        }
+    }
+
+    void reset_stats() override {
+        _stats = cache_stats();
+        _tally.clear();
+        _cache->reset_stats();
+        _mem.reset_peak();
+    }
+
+    std::string statics() override { return _cache->statics(); }
+
+    cache_stats stats() const override {
+        cache_stats s = _stats;
+        s.evictions = _cache->eviction_count();
+        s.resident = _cache->size();
+        s.metadata_bytes = _mem.current();
+        s.metadata_peak = _mem.peak();
+        return s;
+    }
+
+    bool uses_trace_records() const override {
+        return std::is_same<Cache, SCORECache>::value;
+    }
+
+    bool save(snapshot_writer& w) const override {
+        w.put(_stats);
+        return save_cache(*_cache, w);
+    }
+
+    bool load(snapshot_reader& r) override {
+        mem_scope scope(&_mem);
+        cache_stats s;
+        if (!r.get(s) || !load_cache(*_cache, r)) {
+            return false;
+        }
+        _stats = s;
+        return true;
+    }
+
+    bool supports_exclusive() const override { return exclusive_ops<Cache>::value; }
+    bool contains(int block) const override { return contains_block(*_cache, block); }
+    int victim() const override { return victim_of(*_cache); }
+    bool erase(int block) override {
+        mem_scope scope(&_mem);
+        return erase_block(*_cache, block);
+    }
+    void residents(std::vector<int>& out) const override { residents_of(*_cache, out); }
+    void set_eviction_log(std::vector<int>* log) override { set_eviction_log_of(*_cache, log); }
+
+private:
+    const char* _name;
+    mem_account _mem;
+    std::unique_ptr<Cache> _cache;
+    cache_stats _stats;
+    request_tally _tally;
+    miss_cost_model _cost;
+};
+
+template <class Cache, class... Args>
+std::unique_ptr<CachePolicy> make_adapter(const char* name, Args&&... args) {
+    return std::unique_ptr<CachePolicy>(new PolicyAdapter<Cache>(name, std::forward<Args>(args)...));
+}
+
+} // namespace
+
+std::unique_ptr<CachePolicy> make_policy(const std::string& name, int c, const std::string& file_name,
+    policy_allocator alloc) {
+    if (name == "lru")
+        return make_adapter<LRUCache>("lru", c, file_name, alloc);
+    if (name == "lru_pool")
+        return make_adapter<PoolLRUCache>("lru_pool", c, file_name);
+    if (name == "arc")
+        return make_adapter<ARCCache>("arc", c, file_name, alloc);
+    if (name == "score")
+        return make_adapter<SCORECache>("score", c, file_name, alloc);
+    if (name == "tdc")
+        return make_adapter<TDCCache>("tdc", c, file_name, false, alloc);
+    if (name == "tdc_sketch")
+        return make_adapter<TDCCache>("tdc_sketch", c, file_name, true, alloc);
+    if (name == "ceph_tier")
+        return make_adapter<CephTierCache>("ceph_tier", c, file_name);
+    if (name == "ceph_tier_async")
+        return make_adapter<CephTierCache>("ceph_tier_async", c, file_name, true);
+    if (name == "ceph_tier_random")
+        return make_adapter<CephTierCache>("ceph_tier_random", c, file_name, false, candidate_mode::RANDOM);
+    if (name == "tdc2")
+        return make_adapter<tdcCache>("tdc2", c, file_name);
+    if (name == "wtinylfu_lru")
+        return make_adapter<WTinyLFUCache<LRUCache>>("wtinylfu_lru", c, file_name, "wtinylfu_lru_cache", 0.01, alloc);
+    if (name == "wtinylfu_arc")
+        return make_adapter<WTinyLFUCache<ARCCache>>("wtinylfu_arc", c, file_name, "wtinylfu_arc_cache", 0.01, alloc);
+    if (name == "gdsf")
+        return make_adapter<GDSFCache>("gdsf", c, file_name);
+    if (name == "s3fifo")
+        return make_adapter<S3FIFOCache>("s3fifo", c, file_name);
+    if (name == "s3fifo_mt")
+        return make_adapter<ConcurrentS3FIFOCache>("s3fifo_mt", c, file_name);
+    if (name == "lfu")
+        return make_adapter<LFUCache>("lfu", c, file_name);
+    if (name == "lfu_da")
+        return make_adapter<LFUCache>("lfu_da", c, file_name, true);
+    if (name == "lirs")
+        return make_adapter<LIRSCache>("lirs", c, file_name);
+    if (name == "learned")
+        return make_adapter<LearnedCache>("learned", c, file_name, 16, alloc);
+    if (name.compare(0, 8, "adaptive") == 0)
+        return make_adaptive(name, c, file_name, alloc);
+    return nullptr;
+}
+
+const std::vector<std::string>& policy_names() {
+    static const std::vector<std::string> names = {
+        "lru", "lru_pool", "arc", "score", "tdc", "tdc_sketch", "ceph_tier", "ceph_tier_async", "ceph_tier_random", "tdc2",
+        "wtinylfu_lru", "wtinylfu_arc", "gdsf", "s3fifo", "s3fifo_mt", "lfu", "lfu_da", "lirs", "learned",
+        "adaptive",
+    };
+    return names;
+}
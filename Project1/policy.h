@@ -0,0 +1,58 @@
+#pragma once
+// 统一的策略接口：各缓存类的 get() 参数不同，这里按块访问包装成同一形式，
+// 供基准测试等需要"任意策略"的驱动使用
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "TraceLine.h"
+#include "memory_resource.h"
+#include "snapshot.h"
+#include "stats.h"
+
+// 驱动各策略时共享的模拟上下文：SCORE 需要历史 trace_records，TDC 需要周期和请求大小
+struct SimContext {
+    std::vector<trace_line> trace_records;
+    int period = 1;       // TDC 周期
+    double size = 4096;   // 当前请求的字节数
+    int request_number = 0;  // 当前请求所在 trace 行的 request_number
+    bool last_block = true;  // 是否为当前请求的最后一块，按请求统计时在这一块结算
+};
+
+class CachePolicy {
+public:
+    virtual ~CachePolicy() {}
+    virtual const char* name() const = 0;
+    // 访问一个块，返回是否命中
+    virtual bool get(int block, SimContext& ctx) = 0;
+    // 预热用的精简路径：依次访问 [start, start+count) 的块，只更新策略状态，不做统计
+    virtual void warm_line(int start, int count, SimContext& ctx) = 0;
+    // 计数器清零（预热结束时），缓存内容不变
+    virtual void reset_stats() = 0;
+    virtual std::string statics() = 0;
+    // 累计计数器快照：请求/命中/字节在适配层计数，淘汰数和驻留数取自策略本身
+    virtual cache_stats stats() const = 0;
+    // 是否依赖 ctx.trace_records（只有 SCORE 需要，其他策略可以省去追加记录的开销）
+    virtual bool uses_trace_records() const { return false; }
+    // 快照：计数器和策略状态写入/读出 w、r；不支持快照的策略返回 false
+    virtual bool save(snapshot_writer& w) const = 0;
+    virtual bool load(snapshot_reader& r) = 0;
+    // 多级缓存独占模式和自适应策略的专家需要的操作（支持的策略见 policy.cpp 的 exclusive_ops）：
+    // contains 不改变策略状态；victim 为当前状态下一次未命中时将被淘汰的对象，无法预知时返回 -1
+    // （ARC 的幽灵命中会先调整 p，实际淘汰可能不同）；erase 移除对象，不计入淘汰
+    virtual bool supports_exclusive() const = 0;
+    virtual bool contains(int block) const = 0;
+    virtual int victim() const = 0;
+    virtual bool erase(int block) = 0;
+    // 驻留对象按淘汰先后追加到 out（先被淘汰的在前），自适应策略换专家时用；不支持的策略不追加
+    virtual void residents(std::vector<int>& out) const = 0;
+    // 非空时 get() 把实际淘汰的对象追加到 log，由调用方清空；不支持的策略不追加
+    virtual void set_eviction_log(std::vector<int>* log) = 0;
+};
+
+// 按名字创建策略，未知名字返回 nullptr。alloc 为该策略容器的分配器（只影响使用 memory_resource 的策略：
+// lru、arc、score、tdc、wtinylfu、learned），默认取本次运行的选择
+std::unique_ptr<CachePolicy> make_policy(const std::string& name, int c, const std::string& file_name,
+    policy_allocator alloc = current_policy_allocator());
+// 所有可用的策略名
+const std::vector<std::string>& policy_names();
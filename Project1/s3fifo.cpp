@@ -0,0 +1,225 @@
+#include "s3fifo.h"
+#include <sstream>
+
+namespace {
+
+// 小队列中的对象被访问过至少这么多次才进入主队列
+const uint8_t kPromoteFreq = 1;
+const uint8_t kMaxFreq = 3;
+
+} // namespace
+
+S3FIFOCache::S3FIFOCache(int c, std::string file_name) :
+    _capacity(std::max(0, c)),
+    _small_target(std::max<size_t>(1, static_cast<size_t>(std::max(0, c)) / 10)),
+    _file_name(file_name),
+    _slots(static_cast<size_t>(std::max(0, c))),
+    _small(static_cast<size_t>(std::max(0, c))),
+    _main(static_cast<size_t>(std::max(0, c))),
+    _ghost(static_cast<size_t>(std::max(0, c)) - std::min(_small_target, static_cast<size_t>(std::max(0, c)))),
+    _ghost_pushed(0), _hit_count(0), _get_count(0), _eviction_count(0) {
+    _free.reserve(_slots.size());
+    for (size_t i = _slots.size(); i > 0; --i) {
+        _free.push_back(static_cast<uint32_t>(i - 1));
+    }
+    _table.reserve(_slots.size());
+    _ghost_index.reserve(_ghost.capacity());
+}
+
+bool S3FIFOCache::get(int target) {
+    if (_capacity <= 0) {
+        return false;
+    }
+    ++_get_count;
+    if (touch(target)) {
+        ++_hit_count;
+        return true;
+    }
+    insert(target);
+    return false;
+}
+
+bool S3FIFOCache::touch(int target) const {
+    auto it = _table.find(target);
+    if (it == _table.end()) {
+        return false;
+    }
+    // 饱和加一；不用 fetch_add，单线程下就是普通的读和写
+    std::atomic<uint8_t>& f = _slots[it->second].freq;
+    uint8_t v = f.load(std::memory_order_relaxed);
+    if (v < kMaxFreq) {
+        f.store(static_cast<uint8_t>(v + 1), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void S3FIFOCache::insert(int target) {
+    if (_capacity <= 0) {
+        return;
+    }
+    while (_free.empty()) {
+        evict();
+    }
+    uint32_t s = _free.back();
+    _free.pop_back();
+    _slots[s].target = target;
+    _slots[s].freq.store(0, std::memory_order_relaxed);
+    _table[target] = s;
+    if (recall(target)) {
+        _main.push_back(s);
+    }
+    else {
+        _small.push_back(s);
+    }
+}
+
+void S3FIFOCache::evict() {
+    if (_small.size() >= _small_target || _main.empty()) {
+        evict_small();
+    }
+    else {
+        evict_main();
+    }
+}
+
+void S3FIFOCache::evict_small() {
+    while (!_small.empty()) {
+        uint32_t s = _small.pop_front();
+        if (_slots[s].freq.load(std::memory_order_relaxed) >= kPromoteFreq) {
+            _slots[s].freq.store(0, std::memory_order_relaxed);
+            _main.push_back(s);
+            if (_main.size() > static_cast<size_t>(_capacity) - _small_target) {
+                evict_main();
+                return;
+            }
+        }
+        else {
+            remember(_slots[s].target);
+            release(s);
+            return;
+        }
+    }
+    // 小队列里的对象全部晋升了，主队列也未超出目标
+    evict_main();
+}
+
+void S3FIFOCache::evict_main() {
+    while (!_main.empty()) {
+        uint32_t s = _main.pop_front();
+        uint8_t f = _slots[s].freq.load(std::memory_order_relaxed);
+        if (f > 0) {
+            _slots[s].freq.store(static_cast<uint8_t>(f - 1), std::memory_order_relaxed);
+            _main.push_back(s);
+        }
+        else {
+            release(s);
+            return;
+        }
+    }
+}
+
+void S3FIFOCache::release(uint32_t s) {
+    _table.erase(_slots[s].target);
+    _free.push_back(s);
+    ++_eviction_count;
+}
+
+void S3FIFOCache::remember(int target) {
+    if (_ghost.capacity() == 0) {
+        return;
+    }
+    if (_ghost.full()) {
+        uint64_t seq = _ghost_pushed - _ghost.size();
+        auto it = _ghost_index.find(_ghost.pop_front());
+        if (it != _ghost_index.end() && it->second == seq) {
+            _ghost_index.erase(it);
+        }
+    }
+    uint32_t fp = fingerprint(target);
+    _ghost.push_back(fp);
+    _ghost_index[fp] = _ghost_pushed++;
+}
+
+bool S3FIFOCache::recall(int target) {
+    auto it = _ghost_index.find(fingerprint(target));
+    if (it == _ghost_index.end()) {
+        return false;
+    }
+    // 队列中的旧条目留到出队时再清理
+    _ghost_index.erase(it);
+    return true;
+}
+
+// 32 位指纹；不同对象的指纹冲突只会让对象误入主队列，不影响正确性
+uint32_t S3FIFOCache::fingerprint(int target) {
+    uint64_t x = static_cast<uint32_t>(target) * 0x9e3779b97f4a7c15ULL;
+    return static_cast<uint32_t>(x >> 32);
+}
+
+std::string S3FIFOCache::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << " s3fifo_cache:"
+        << " cache_size:" << _capacity
+        << " request:" << _get_count
+        << " hit:" << _hit_count
+        << " miss:" << _get_count - _hit_count
+        << " hit_rate:" << (_get_count ? 1.0 * _hit_count / _get_count : 0.0)
+        << " small:" << _small.size()
+        << " main:" << _main.size()
+        << " ghost:" << _ghost_index.size() << std::endl;
+    return s.str();
+}
+
+bool ConcurrentS3FIFOCache::get(int target) {
+    _get_count.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::shared_lock<std::shared_timed_mutex> shared(_lock);
+        if (_cache.touch(target)) {
+            _hit_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    std::unique_lock<std::shared_timed_mutex> exclusive(_lock);
+    // 等锁期间可能已被其他线程插入
+    if (_cache.touch(target)) {
+        _hit_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    _cache.insert(target);
+    return false;
+}
+
+unsigned int ConcurrentS3FIFOCache::eviction_count() const {
+    std::shared_lock<std::shared_timed_mutex> shared(_lock);
+    return _cache.eviction_count();
+}
+
+size_t ConcurrentS3FIFOCache::size() const {
+    std::shared_lock<std::shared_timed_mutex> shared(_lock);
+    return _cache.size();
+}
+
+void ConcurrentS3FIFOCache::reset_stats() {
+    std::unique_lock<std::shared_timed_mutex> exclusive(_lock);
+    _cache.reset_stats();
+    _hit_count = 0;
+    _get_count = 0;
+}
+
+bool ConcurrentS3FIFOCache::contains(int target) const {
+    std::shared_lock<std::shared_timed_mutex> shared(_lock);
+    return _cache.contains(target);
+}
+
+std::string ConcurrentS3FIFOCache::statics() {
+    unsigned int gets = _get_count;
+    unsigned int hits = _hit_count;
+    std::stringstream s;
+    s << "trace:" << _file_name << " s3fifo_mt_cache:"
+        << " cache_size:" << _capacity
+        << " request:" << gets
+        << " hit:" << hits
+        << " miss:" << gets - hits
+        << " hit_rate:" << (gets ? 1.0 * hits / gets : 0.0) << std::endl;
+    return s.str();
+}
@@ -0,0 +1,124 @@
+#pragma once
+// S3-FIFO：小 FIFO（约 10% 容量，新对象的试用区）+ 主 FIFO（2 位频率计数）+ 幽灵 FIFO（指纹）
+// 三个队列都是构造时分配好的环形缓冲区，命中只把对象的计数器加一，不移动任何链表节点
+//   小队列淘汰：试用期间被访问过的对象移入主队列，否则淘汰并把指纹放入幽灵队列
+//   主队列淘汰：计数器非零的对象计数减一后重新入队（CLOCK 式二次机会），为零时淘汰
+//   未命中且指纹在幽灵队列中的对象直接进入主队列
+// 一次性扫描只经过小队列，不会冲掉主队列里的热点
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 定长环形队列：容量在构造时确定，入队前调用方保证未满
+template <class T>
+class ring_buffer {
+public:
+    explicit ring_buffer(size_t capacity) :
+        _buf(std::max<size_t>(1, capacity)), _head(0), _size(0) {}
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _buf.size(); }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == _buf.size(); }
+
+    void push_back(const T& v) {
+        size_t tail = _head + _size;
+        _buf[tail < _buf.size() ? tail : tail - _buf.size()] = v;
+        ++_size;
+    }
+    T pop_front() {
+        T v = _buf[_head];
+        _head = _head + 1 == _buf.size() ? 0 : _head + 1;
+        --_size;
+        return v;
+    }
+
+private:
+    std::vector<T> _buf;
+    size_t _head;
+    size_t _size;
+};
+
+class S3FIFOCache {
+public:
+    explicit S3FIFOCache(int c, std::string file_name);
+
+    S3FIFOCache(const S3FIFOCache&) = delete;
+    S3FIFOCache& operator=(const S3FIFOCache&) = delete;
+
+    bool get(int target);
+    // 只查找：命中时计数器加一并返回 true，未命中不插入、不计数。
+    // 只读哈希表、计数器为原子变量，可以在共享锁下与其他 touch 并发
+    bool touch(int target) const;
+    // 插入一个不在缓存中的对象，必要时先淘汰
+    void insert(int target);
+
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _small.size() + _main.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    bool contains(int target) const { return _table.find(target) != _table.end(); }
+
+private:
+    struct slot {
+        int target;
+        mutable std::atomic<uint8_t> freq;  // 0..3；并发命中之间的竞争最多少记一次，不影响正确性
+    };
+
+    void evict();
+    void evict_small();
+    void evict_main();
+    void release(uint32_t s);
+    void remember(int target);
+    // 指纹在幽灵队列中则将其移除并返回 true
+    bool recall(int target);
+    static uint32_t fingerprint(int target);
+
+    int _capacity;
+    size_t _small_target;   // 小队列的目标大小
+    std::string _file_name;
+    std::vector<slot> _slots;          // 对象槽位，队列里存槽位号
+    std::vector<uint32_t> _free;       // 空闲槽位栈
+    std::unordered_map<int, uint32_t> _table;  // target -> 槽位号
+    ring_buffer<uint32_t> _small;
+    ring_buffer<uint32_t> _main;
+    ring_buffer<uint32_t> _ghost;      // 被小队列淘汰的对象指纹
+    std::unordered_map<uint32_t, uint64_t> _ghost_index;  // 指纹 -> 最近一次入队序号
+    uint64_t _ghost_pushed;            // 幽灵队列累计入队数，队头序号为 _ghost_pushed - size
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _eviction_count;
+};
+
+// 线程安全版本：命中路径只取共享锁（查表 + 原子计数），未命中时取独占锁插入和淘汰
+class ConcurrentS3FIFOCache {
+public:
+    explicit ConcurrentS3FIFOCache(int c, std::string file_name) :
+        _cache(c, file_name), _file_name(file_name), _capacity(c), _hit_count(0), _get_count(0) {}
+
+    ConcurrentS3FIFOCache(const ConcurrentS3FIFOCache&) = delete;
+    ConcurrentS3FIFOCache& operator=(const ConcurrentS3FIFOCache&) = delete;
+
+    bool get(int target);
+    std::string statics();
+    unsigned int hit_count() const { return _hit_count.load(std::memory_order_relaxed); }
+    unsigned int eviction_count() const;
+    size_t size() const;
+    void reset_stats();
+    bool contains(int target) const;
+
+private:
+    S3FIFOCache _cache;
+    mutable std::shared_timed_mutex _lock;
+    std::string _file_name;
+    int _capacity;
+    std::atomic<unsigned int> _hit_count;
+    std::atomic<unsigned int> _get_count;
+};
@@ -8,10 +8,10 @@
 
 
 // 温度计算函数
-std::unordered_map<int, TemperatureRecord> SCORECache::calculateTemperature(const std::vector<trace_line>& trace_records) {
+temperature_table SCORECache::calculateTemperature(const std::vector<trace_line>& trace_records) {
     const double k = 0.5;
 
-    std::unordered_map<int, TemperatureRecord> temperatureTable;
+    temperature_table temperatureTable(0, &_scratch);
     // 初始化随机数生成器和分布
     std::mt19937 gen(std::random_device{}()); // Standard mersenne_twister_engine seeded with random_device
     std::uniform_real_distribution<> dis(1.0, 100.0); // 分布在 1.0 到 100.0 之间
@@ -70,8 +70,8 @@ std::unordered_map<int, TemperatureRecord> SCORECache::calculateTemperature(cons
     return temperatureTable;
 }
 // 计算温度密度函数
-std::unordered_map<int, double>  SCORECache::calculateDensity(const std::unordered_map<int, TemperatureRecord>& temperatureTable, const std::vector<trace_line>& trace_records) {
-    std::unordered_map<int, double> densityTable;
+score_table  SCORECache::calculateDensity(const temperature_table& temperatureTable, const std::vector<trace_line>& trace_records) {
+    score_table densityTable(0, &_scratch);
     // 获取系统当前时间
 
 
@@ -107,8 +107,8 @@ std::unordered_map<int, double>  SCORECache::calculateDensity(const std::unorder
     return densityTable;
 }
 
-std::unordered_map<int, double>  SCORECache::calculateImportance(const std::vector<trace_line>& trace_records) {
-    std::unordered_map<int, double> importance_table;
+score_table  SCORECache::calculateImportance(const std::vector<trace_line>& trace_records) {
+    score_table importance_table(0, &_scratch);
 
     // 优化：只遍历一次，对于每个 request_number，如果是第一次遇到，记录它的 access_count
     // 这保持了原逻辑（取第一次出现的 access_count），但复杂度从 O(n²) 降为 O(n)
@@ -128,8 +128,8 @@ std::unordered_map<int, double>  SCORECache::calculateImportance(const std::vect
     }
     return importance_table;
 }
-std::unordered_map<int, double>  SCORECache::normalizeImportanceTable(const std::unordered_map<int, double>& importance_table) {
-    std::unordered_map<int, double> k_important;
+score_table  SCORECache::normalizeImportanceTable(const score_table& importance_table) {
+    score_table k_important(0, &_scratch);
 
     // 如果 importance_table 为空，直接返回空表
     if (importance_table.empty()) {
@@ -164,8 +164,8 @@ std::unordered_map<int, double>  SCORECache::normalizeImportanceTable(const std:
     return k_important;
 
 }
-std::unordered_map<int, double> SCORECache::calculateKdensityTable(const std::unordered_map<int, double>& densityTable) {
-    std::unordered_map<int, double> k_density;
+score_table SCORECache::calculateKdensityTable(const score_table& densityTable) {
+    score_table k_density(0, &_scratch);
 
     // 如果 densityTable 为空，直接返回空表
     if (densityTable.empty()) {
@@ -194,27 +194,27 @@ std::unordered_map<int, double> SCORECache::calculateKdensityTable(const std::un
 
     return k_density;
 }
-std::vector<int> SCORECache::evit(const std::unordered_map<int, double>& k_importance, const std::unordered_map<int, double>& k_density) {
+std::vector<int> SCORECache::evit(const score_table& k_importance, const score_table& k_density) {
     // 计算每个对象的 score
-    std::unordered_map<int, double> score_table;
+    score_table scores(0, &_scratch);
 
     for (const auto& entry : k_importance) {
         if (k_density.find(entry.first) != k_density.end()) {
             double score = k_importance.at(entry.first) + k_density.at(entry.first);
-            score_table[entry.first] = score;
+            scores[entry.first] = score;
         }
     }
 
     // 计算平均值
     double avg_score = 0.0;
-    for (const auto& entry : score_table) {
+    for (const auto& entry : scores) {
         avg_score += entry.second;
     }
-    avg_score /= score_table.size();
+    avg_score /= scores.size();
 
     // 淘汰低于平均值的对象
     std::vector<int> to_remove;
-    for (const auto& entry : score_table) {
+    for (const auto& entry : scores) {
         if (entry.second < avg_score) {
             to_remove.push_back(entry.first);
         }
@@ -243,12 +243,12 @@ int SCORECache::get(const SCOREParams& scoreparam) {
         if (_items.size() >= _c) {
             // 如果缓存已满，执行淘汰算法
             const std::vector<trace_line>& trace_records = scoreparam.trace_records;
-            std::unordered_map<int, TemperatureRecord> temperatureTable = calculateTemperature(trace_records);
-            std::unordered_map<int, double> densityTable = calculateDensity(temperatureTable, trace_records);
+            temperature_table temperatureTable = calculateTemperature(trace_records);
+            score_table densityTable = calculateDensity(temperatureTable, trace_records);
 
-            std::unordered_map<int, double> importance_table = calculateImportance(trace_records);
-            std::unordered_map<int, double> k_density = calculateKdensityTable(densityTable);
-            std::unordered_map<int, double> k_important = normalizeImportanceTable(importance_table);
+            score_table importance_table = calculateImportance(trace_records);
+            score_table k_density = calculateKdensityTable(densityTable);
+            score_table k_important = normalizeImportanceTable(importance_table);
             auto to_remove = evit(k_important, k_density);
 
             // 从 _items 和 _table 中删除被淘汰的对象
@@ -257,9 +257,12 @@ int SCORECache::get(const SCOREParams& scoreparam) {
                 if (it != _table.end()) {
                     _items.erase(it->second);
                     _table.erase(it);
+                    ++_eviction_count;
                 }
             }
         }
+        // 本次淘汰的临时表都已析构，暂存区整体回收
+        _scratch.reset();
         // 在 _items 和 _table 中添加新对象
         _items.emplace_front(scoreparam.target, scoreparam.target);
         _table[scoreparam.target] = _items.begin();
@@ -1,8 +1,10 @@
+#pragma once
 #include <unordered_map>
 #include <list>
 #include <sstream>
 #include <cstdint>
 #include "TraceLine.h"
+#include "memory_resource.h"
 // ṹ࣬ʾ¶ȱԪ
 struct TemperatureRecord {
     int object_id;
@@ -11,6 +13,10 @@ struct TemperatureRecord {
     double last_access_time;  //  last_access_time ޸Ϊ double
 };
 
+// ̭ʱʱ SCORECache::_scratch 䣬ÿ̭
+using temperature_table = resource_map<int, TemperatureRecord>;
+using score_table = resource_map<int, double>;
+
 struct  SCOREParams {
     int target;
     const std::vector<trace_line>& trace_records;
@@ -20,8 +26,9 @@ struct  SCOREParams {
 class SCORECache {
 
 public:
-    explicit  SCORECache(int c, std::string file_name) :
-        _c(c), _file_name(file_name), _hit_count(0), _get_count(0) {}
+    explicit  SCORECache(int c, std::string file_name, policy_allocator alloc = current_policy_allocator()) :
+        _resource(make_policy_resource(alloc)), _items(_resource.get()), _table(0, _resource.get()),
+        _c(c), _hit_count(0), _get_count(0), _eviction_count(0), _file_name(file_name) {}
     //int get(const  resultTable& params);
     SCORECache(const  SCORECache&) = delete;
     SCORECache& operator=(const  SCORECache&) = delete;
@@ -31,21 +38,29 @@ public:
 public:
     int get(const SCOREParams& scoreparam);
     std::string statics();
-    std::unordered_map<int, TemperatureRecord> calculateTemperature(const std::vector<trace_line>& trace_records);
-    std::unordered_map<int, double> calculateDensity(const std::unordered_map<int, TemperatureRecord>& temperatureTable, const std::vector<trace_line>& trace_records);
+    unsigned int hit_count() const { return _hit_count; }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _items.size(); }
+    void reset_stats() { _hit_count = _get_count = _eviction_count = 0; }
+    temperature_table calculateTemperature(const std::vector<trace_line>& trace_records);
+    score_table calculateDensity(const temperature_table& temperatureTable, const std::vector<trace_line>& trace_records);
     // ӵĺ
-    std::unordered_map<int, double> calculateImportance(const std::vector<trace_line>& trace_records);
+    score_table calculateImportance(const std::vector<trace_line>& trace_records);
     //void normalizeTable(std::unordered_map<int, double>& table);
-    std::unordered_map<int, double> normalizeImportanceTable(const std::unordered_map<int, double>& importance_table);
+    score_table normalizeImportanceTable(const score_table& importance_table);
     //std::unordered_map<int, double> calculateDensityAndImportance(const std::vector<trace_line>& trace_records, const std::unordered_map<int, TemperatureRecord>& temperatureTable);
-    std::unordered_map<int, double> calculateKdensityTable(const std::unordered_map<int, double>& temperatureTable);
-    std::vector<int>  evit(const std::unordered_map<int, double>& k_importance, const std::unordered_map<int, double>& k_density);
+    score_table calculateKdensityTable(const score_table& temperatureTable);
+    std::vector<int>  evit(const score_table& k_importance, const score_table& k_density);
     //resultTable calculateKValues(const std::unordered_map<int, double>& importance_table, const std::unordered_map<int, double>& densityTable);
     bool cache_full();
     // std::unordered_map<int, std::pair<double, double>> calculateDensityAndImportance(const std::unordered_map<int, TemperatureRecord>& temperatureTable, const std::vector<trace_line>& trace_records);
 private:
-    std::list<std::pair<int, int>> _items; // (target, cache_addr) 
-    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> _table;
+    using item_list = resource_list<std::pair<int, int>>;
+
+    std::unique_ptr<memory_resource> _resource;  // ڵڴ
+    monotonic_resource _scratch;
+    item_list _items; // (target, cache_addr) 
+    resource_map<int, item_list::iterator> _table;
 
     std::unordered_map<int, double> scoreTable;
 
@@ -53,5 +68,6 @@ private:
     int _c;
     unsigned int _hit_count;
     unsigned int _get_count;
+    unsigned int _eviction_count;
     std::string _file_name;
 };
\ No newline at end of file
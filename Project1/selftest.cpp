@@ -0,0 +1,302 @@
+#include "selftest.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "csv_trace.h"
+#include "hierarchy.h"
+#include "policy.h"
+#include "sim.h"
+#include "trc.h"
+
+namespace {
+
+int g_failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        ++g_failures;
+        std::cout << "FAIL " << what << std::endl;
+    }
+}
+
+bool write_file(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    return static_cast<bool>(out);
+}
+
+std::vector<trace_line> read_all(TraceSource& source) {
+    std::vector<trace_line> lines;
+    trace_line l;
+    while (source.next(l)) {
+        lines.push_back(l);
+    }
+    return lines;
+}
+
+// KV trace：每个 key 占一段互不重叠的块区间，DELETE 与未知操作不产生访问，length() 为产出条数
+void test_kv_trace() {
+    const std::string path = "selftest_twitter.csv";
+    check(write_file(path,
+        "1,a,100,9000,1,get,0\n"      // 3 块：[0, 3)
+        "2,b,10,10,1,set,0\n"         // 1 块：[3, 4)
+        "3,c,10,10,1,delete,0\n"      // 跳过，不保留块
+        "4,a,100,9000,1,gets,0\n"     // 仍是 [0, 3)
+        "5,d,10,10,1,flush,0\n"       // 跳过
+        "6,b,10,12000,1,set,0\n"),    // 变大为 3 块，改到 [4, 7)
+        "write " + path);
+    bool matched = false;
+    std::unique_ptr<TraceSource> source = open_csv_trace("twitter:" + path, &matched);
+    check(matched && source != nullptr, "open twitter trace");
+    if (source) {
+        check(source->length() == 4, "twitter length() counts emitted records");
+        std::vector<trace_line> lines = read_all(*source);
+        check(lines.size() == 4, "twitter skips delete/other operations");
+        if (lines.size() == 4) {
+            check(lines[0].starting_block == 0 && lines[0].size_of_blocks == 3, "twitter key a -> [0, 3)");
+            check(lines[1].starting_block == 3 && lines[1].size_of_blocks == 1, "twitter key b -> [3, 4)");
+            check(lines[2].starting_block == 0 && lines[2].size_of_blocks == 3, "twitter key a keeps its range");
+            check(lines[3].starting_block == 4 && lines[3].size_of_blocks == 3, "twitter key b grows to [4, 7)");
+            check(lines[1].ignore == OP_WRITE && lines[2].ignore == OP_READ, "twitter op types");
+        }
+    }
+    source.reset();
+    std::remove(path.c_str());
+
+    const std::string meta = "selftest_meta.csv";
+    check(write_file(meta,
+        "op_time,key,key_size,op,op_count,size\n"
+        "0,x,10,GET,3,100\n"          // 展开为 3 次
+        "1,y,10,DELETE,5,100\n"       // 跳过，不展开
+        "2,z,10,SET,1,5000\n"),       // 2 块，接在 x 之后
+        "write " + meta);
+    source = open_csv_trace("meta:" + meta, &matched);
+    check(source != nullptr, "open meta trace");
+    if (source) {
+        check(source->length() == 4, "meta length() counts op_count expansion and skips deletes");
+        std::vector<trace_line> lines = read_all(*source);
+        check(lines.size() == 4, "meta emitted records");
+        if (lines.size() == 4) {
+            check(lines[2].starting_block == 0 && lines[3].starting_block == 1 && lines[3].size_of_blocks == 2,
+                "meta key ranges");
+        }
+    }
+    source.reset();
+    std::remove(meta.c_str());
+}
+
+trace_line request(int block, int blocks) {
+    trace_line l;
+    l.starting_block = block;
+    l.size_of_blocks = blocks;
+    l.ignore = OP_READ;
+    l.request_number = 0;
+    l.current_time = 0;
+    l.access_count = 0;
+    return l;
+}
+
+// 块命中率按块计，对象命中率与字节命中率按请求计（所有块都命中才算命中）。
+// 依次读 [0, 1)（未命中）、[0, 4)（部分命中）、[0, 4)（命中）：
+// 块 5/9，对象 1/3，字节 16KB/36KB，三者各不相同
+void test_byte_hit_rate() {
+    std::vector<std::unique_ptr<CachePolicy>> policies;
+    policies.push_back(make_policy("lru", 16, "selftest"));
+    policies.push_back(make_policy("gdsf", 16, "selftest"));
+    SimOptions options;
+    options.progress = false;
+    Simulator sim(std::move(policies), options);
+    trace_line a = request(0, 1);
+    trace_line b = request(0, 4);
+    trace_line c = request(0, 4);
+    sim.access_line(a);
+    sim.access_line(b);
+    sim.access_line(c);
+    for (size_t k = 0; k < 2; ++k) {
+        cache_stats st = sim.policy(k).stats();
+        std::string name = sim.policy(k).name();
+        check(st.requests == 9 && st.hits == 5, "byte hit rate: " + name + " block counts");
+        check(st.object_requests == 3 && st.object_hits == 1, "byte hit rate: " + name + " object counts");
+        check(st.bytes_requested == 9 * 4096.0 && st.bytes_hit == 4 * 4096.0, "byte hit rate: " + name + " request bytes");
+    }
+    std::string report = sim.statics();
+    check(report.find("object_hit_rate:0.333333 byte_hit_rate:0.444444 ") != std::string::npos,
+        "byte hit rate: object and byte ratios reported separately");
+}
+
+// 支持独占操作的策略：residents() 恰好列出全部驻留对象，第一个就是 victim()
+void test_residents() {
+    const char* names[] = { "lru", "lru_pool", "arc", "lfu", "lfu_da", "lirs", "gdsf" };
+    for (const char* name : names) {
+        std::unique_ptr<CachePolicy> p = make_policy(name, 64, "selftest");
+        SimContext ctx;
+        uint64_t x = 12345;
+        for (int i = 0; i < 5000; ++i) {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+            p->get(static_cast<int>((x >> 33) % 200), ctx);
+        }
+        std::vector<int> out;
+        p->residents(out);
+        bool all = true;
+        for (int b : out) {
+            all = all && p->contains(b);
+        }
+        std::string tag = std::string("residents: ") + name;
+        check(out.size() == p->stats().resident && all, tag + " lists every resident object");
+        check(!out.empty() && (p->victim() < 0 || out.front() == p->victim()), tag + " starts with victim()");
+    }
+}
+
+} // namespace
+
+// .trc 的段索引必须首尾相接地铺满数据区，偏移或长度错位的文件在 open() 时拒绝
+void test_trc_index() {
+    const std::string path = "selftest_index.trc";
+    std::unique_ptr<TraceSource> synth = open_trace("synth:uniform,keys=100@5000");
+    std::string error;
+    check(synth && write_trc(*synth, path, &error, 1000), "write " + path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const size_t footer = 8 + 8 + 4 + 4 + 4;
+    uint64_t index_offset = 0;
+    if (bytes.size() >= footer) {
+        std::memcpy(&index_offset, bytes.data() + bytes.size() - footer, sizeof(index_offset));
+    }
+    check(index_offset > 8 && index_offset + 5 * 16 + footer == bytes.size(), "trc layout");
+    if (index_offset + 5 * 16 + footer != bytes.size()) {
+        return;
+    }
+    {
+        TrcTraceSource ok;
+        check(ok.open(path.c_str(), &error) && ok.length() == 5000 && read_all(ok).size() == 5000,
+            "read intact trc");
+    }
+    // 第二段的偏移后移一个字节
+    std::string shifted = bytes;
+    ++shifted[static_cast<size_t>(index_offset) + 16];
+    // 最后一段的长度越过索引起点
+    std::string overlong = bytes;
+    overlong[static_cast<size_t>(index_offset) + 4 * 16 + 8 + 3] = 0x7f;
+    // 索引起点指到文件之外
+    std::string outside = bytes;
+    outside[bytes.size() - footer + 7] = 0x7f;
+    const std::string* bad[] = { &shifted, &overlong, &outside };
+    const char* what[] = { "shifted chunk offset", "chunk past index", "index past end" };
+    for (int i = 0; i < 3; ++i) {
+        check(write_file(path, *bad[i]), "write " + path);
+        TrcTraceSource t;
+        check(!t.open(path.c_str(), &error), std::string("trc rejects ") + what[i]);
+    }
+    std::remove(path.c_str());
+}
+
+// 独占多级缓存：下一级足够大时，第一级挤出的块必须全部降级下去，两级合起来恰好是访问过的全部块。
+// ARC 的幽灵命中会在淘汰前调整 p，只按 victim() 预测时会漏掉一部分降级
+void test_exclusive_demotion() {
+    const char* names[] = { "lru", "lru_pool", "arc", "lfu", "lirs", "gdsf" };
+    for (const char* name : names) {
+        std::vector<tier_config> tiers(2);
+        tiers[0].policy = name;
+        tiers[0].capacity = 64;
+        tiers[1].policy = "lru";
+        tiers[1].capacity = 1000;
+        tier_config backing;
+        backing.policy = "backing";
+        TierHierarchy h(tiers, backing, true, "selftest");
+        std::string error;
+        check(h.init(&error), std::string("exclusive hierarchy with ") + name);
+        std::vector<bool> seen(500, false);
+        size_t distinct = 0;
+        uint32_t x = 12345;
+        for (int i = 0; i < 20000; ++i) {
+            x = x * 1103515245u + 12345u;
+            // 两段叠加：小热点反复访问，形成 ARC 的 T2 和幽灵命中
+            int block = (x >> 16) % 4 == 0 ? static_cast<int>((x >> 8) % 500) : static_cast<int>((x >> 8) % 80);
+            distinct += seen[block] ? 0 : 1;
+            seen[block] = true;
+            h.access_line(request(block, 1));
+        }
+        cache_stats top = h.tier(0).stats();
+        cache_stats bottom = h.tier(1).stats();
+        check(top.resident + bottom.resident == distinct,
+            std::string("exclusive hierarchy keeps every block: ") + name);
+        int both = 0;
+        for (int b = 0; b < 500; ++b) {
+            both += h.tier(0).contains(b) && h.tier(1).contains(b) ? 1 : 0;
+        }
+        check(both == 0, std::string("exclusive hierarchy holds each block once: ") + name);
+    }
+}
+
+// 自适应策略换专家后旧实例逐步清空：任何时刻两个实例合计不超过容量，residents() 与驻留数一致。
+// 2500 个 key 的循环夹杂一次性扫描，超过容量的循环让 LRU 全部未命中，从默认的第一个专家 lru 切到 lirs
+void test_adaptive_drain() {
+    const int c = 2000;
+    std::unique_ptr<CachePolicy> p = make_policy("adaptive:lru+lirs", c, "selftest");
+    check(p != nullptr, "adaptive:lru+lirs");
+    if (!p) {
+        return;
+    }
+    SimContext ctx;
+    bool bounded = true;
+    for (int i = 0; i < 400000; ++i) {
+        int block = i % 4 != 0 ? i % 2500 : 100000 + i;
+        p->get(block, ctx);
+        if (i % 1000 == 0 && p->stats().resident > static_cast<uint64_t>(c)) {
+            bounded = false;
+        }
+    }
+    check(bounded, "adaptive: old and new instance stay within capacity");
+    check(p->statics().find(" switches:0 ") == std::string::npos, "adaptive: switches from lru to lirs");
+    check(p->stats().hits > 250000, "adaptive: hit rate follows lirs after the switch");
+    std::vector<int> out;
+    p->residents(out);
+    check(out.size() == p->stats().resident, "adaptive: residents() matches resident count");
+    size_t loop = 0;
+    for (int b = 0; b < 2500; ++b) {
+        loop += p->contains(b) ? 1 : 0;
+    }
+    check(loop > 1500, "adaptive: loop keys retained after the switch");
+}
+
+// 分配器按策略指定：同一进程里的 pool 与 malloc 实例互不影响，全局默认不变。
+// pool_resource 首次分配就申请 64KB 的大块，按节点分配的 malloc 实例远小于此
+void test_policy_allocator() {
+    policy_allocator before = current_policy_allocator();
+    const char* names[] = { "lru", "arc", "adaptive:lru+arc" };
+    for (const char* name : names) {
+        std::unique_ptr<CachePolicy> pooled = make_policy(name, 16, "selftest", policy_allocator::POOL);
+        std::unique_ptr<CachePolicy> plain = make_policy(name, 16, "selftest", policy_allocator::MALLOC);
+        SimContext ctx;
+        for (int i = 0; i < 10; ++i) {
+            pooled->get(i, ctx);
+            plain->get(i, ctx);
+        }
+        check(pooled->stats().metadata_bytes >= 64 * 1024, std::string("allocator: ") + name + " uses its pool");
+        check(plain->stats().metadata_bytes < 64 * 1024, std::string("allocator: ") + name + " uses malloc");
+    }
+    check(current_policy_allocator() == before, "allocator: process default unchanged");
+}
+
+int run_selftest(int, char**) {
+    test_kv_trace();
+    test_byte_hit_rate();
+    test_residents();
+    test_trc_index();
+    test_exclusive_demotion();
+    test_adaptive_drain();
+    test_policy_allocator();
+    if (g_failures > 0) {
+        std::cout << g_failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
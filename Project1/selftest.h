@@ -0,0 +1,3 @@
+#pragma once
+// 自检：SCORE.exe --selftest，逐项检查 trace 解析与统计口径，全部通过返回 0
+int run_selftest(int argc, char** argv);
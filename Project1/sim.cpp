@@ -0,0 +1,361 @@
+#include "sim.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const size_t kBatchLines = 4096;     // 每次从 trace 来源批量读取的行数
+const size_t kWarmupChunk = 65536;   // 预热时每段交给各策略的行数
+
+std::vector<std::string> names_of(const std::vector<std::unique_ptr<CachePolicy>>& policies) {
+    std::vector<std::string> names;
+    for (const auto& p : policies) {
+        names.push_back(p->name());
+    }
+    return names;
+}
+
+} // namespace
+
+double wall_clock_ms() {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count());
+}
+
+Simulator::Simulator(std::vector<std::unique_ptr<CachePolicy>> policies, const SimOptions& options) :
+    _policies(std::move(policies)), _options(options), _records(false),
+    _line_count(0), _request_count(0), _latency(_policies.size()),
+    _sample_countdown(options.latency_sample),
+    _windowed(options.window_requests > 0 || options.window_time > 0),
+    _series(names_of(_policies)), _snapshot(_policies.size()),
+    _next_window_request(options.window_requests), _next_window_time(0),
+    _snapshot_request(0), _last_time(0) {
+    for (const auto& p : _policies) {
+        _records = _records || p->uses_trace_records();
+    }
+}
+
+void Simulator::access_line(trace_line& l) {
+    _last_time = l.current_time;
+    // 按虚拟时间分窗：第一条请求确定起点
+    if (_options.window_time > 0) {
+        if (_next_window_time == 0) {
+            _next_window_time = l.current_time + _options.window_time;
+        }
+        while (l.current_time >= _next_window_time) {
+            take_snapshot(_next_window_time);
+            _next_window_time += _options.window_time;
+        }
+    }
+    for_each_block(l, _ctx, _request_count, _records, [&](int i) {
+        // 抽样计时：只有被抽中的请求才读取计时源，其余请求没有额外开销
+        if (_options.latency_sample > 0 && --_sample_countdown == 0) {
+            _sample_countdown = _options.latency_sample;
+            for (size_t k = 0; k < _policies.size(); ++k) {
+                uint64_t t0 = latency_ticks();
+                bool hit = _policies[k]->get(i, _ctx);
+                _latency[k].add(hit, latency_ticks() - t0);
+            }
+        }
+        else {
+            for (auto& p : _policies) {
+                p->get(i, _ctx);
+            }
+        }
+        if (_options.window_requests > 0 && _request_count >= _next_window_request) {
+            take_snapshot(l.current_time);
+            _next_window_request += _options.window_requests;
+        }
+    });
+}
+
+namespace {
+
+// 预热时一个策略处理一段 trace：按 TDC 周期边界切分每行，同一段内的块一次交给策略。
+// ctx 是该策略自己的副本，request 为这段开始时的请求序号
+void warm_policy(CachePolicy& p, const std::vector<trace_line>& lines, SimContext ctx, uint64_t request) {
+    for (const auto& l : lines) {
+        ctx.size = l.size_of_blocks * kBlockBytes;
+        ctx.request_number = l.request_number;
+        int block = l.starting_block;
+        int remaining = l.size_of_blocks;
+        while (remaining > 0) {
+            if (request % kPeriodRequests == 0) {
+                ++ctx.period;
+            }
+            uint64_t room = kPeriodRequests - request % kPeriodRequests;
+            int count = room < static_cast<uint64_t>(remaining) ? static_cast<int>(room) : remaining;
+            p.warm_line(block, count, ctx);
+            block += count;
+            remaining -= count;
+            request += count;
+        }
+    }
+}
+
+} // namespace
+
+// 预热：不做统计、计时、分窗和进度输出。各策略互不共享状态，按策略并行处理整段 trace；
+// SCORE 依赖 trace_records 做淘汰，有它时退回逐块顺序处理以保持记录与访问的先后关系
+void Simulator::flush_warmup() {
+    if (_warmup_lines.empty()) {
+        return;
+    }
+    if (_records) {
+        for (const auto& l : _warmup_lines) {
+            for_each_block(l, _ctx, _request_count, true, [&](int i) {
+                for (auto& p : _policies) {
+                    p->warm_line(i, 1, _ctx);
+                }
+            });
+        }
+    }
+    else {
+        size_t threads = _options.warmup_threads > 0 ? static_cast<size_t>(_options.warmup_threads)
+            : std::max(1u, std::thread::hardware_concurrency());
+        for (size_t first = 0; first < _policies.size(); first += threads) {
+            size_t last = std::min(_policies.size(), first + threads);
+            std::vector<std::thread> workers;
+            for (size_t k = first + 1; k < last; ++k) {
+                workers.emplace_back(warm_policy, std::ref(*_policies[k]), std::cref(_warmup_lines), _ctx, _request_count);
+            }
+            warm_policy(*_policies[first], _warmup_lines, _ctx, _request_count);
+            for (auto& t : workers) {
+                t.join();
+            }
+        }
+        // 推进共享的请求计数和 TDC 周期
+        for (const auto& l : _warmup_lines) {
+            for (int i = 0; i < l.size_of_blocks; ++i) {
+                if (_request_count % kPeriodRequests == 0) {
+                    ++_ctx.period;
+                }
+                ++_request_count;
+            }
+        }
+    }
+    _line_count += _warmup_lines.size();
+    _last_time = _warmup_lines.back().current_time;
+    _warmup_lines.clear();
+}
+
+// 预热结束：清零所有计数，之后的统计、延迟和分窗只反映测量阶段
+void Simulator::finish_warmup() {
+    for (auto& p : _policies) {
+        p->reset_stats();
+    }
+    for (auto& l : _latency) {
+        l = latency_stats_t();
+    }
+    _sample_countdown = _options.latency_sample;
+    _snapshot_request = _request_count;
+    _next_window_request = _request_count + _options.window_requests;
+    _next_window_time = 0;
+    _clock.start();
+}
+
+void Simulator::run(TraceSource& source) {
+    // 从检查点恢复时跳过已经处理过的行
+    if (_line_count > 0 && source.skip(_line_count) != _line_count) {
+        std::cerr << "trace is shorter than the checkpoint (" << _line_count << " lines)" << std::endl;
+        return;
+    }
+    // 预热长度：按请求数和/或按 trace 行数比例，两者都满足才结束
+    uint64_t warmup_lines = 0;
+    if (_options.warmup_fraction > 0) {
+        warmup_lines = static_cast<uint64_t>(_options.warmup_fraction * source.length());
+    }
+    bool warming = warmup_lines > 0 || _options.warmup_requests > 0;
+    const uint64_t warmup_end_line = _line_count + warmup_lines;
+    const uint64_t warmup_end_request = _request_count + _options.warmup_requests;
+    const uint64_t first_request = _request_count;
+    uint64_t pending_requests = _request_count;  // 已读入（含尚未处理）的请求数
+    uint64_t measured_from = _request_count;
+
+    // 记录开始时间，用于计算耗时
+    auto start_time = std::chrono::steady_clock::now();
+    auto measure_start = start_time;
+    std::vector<trace_line> batch(kBatchLines);
+    size_t n;
+    while ((n = source.next_batch(batch.data(), batch.size())) > 0) {
+        size_t k = 0;
+        if (warming) {
+            for (; warming && k < n; ++k) {
+                _warmup_lines.push_back(batch[k]);
+                pending_requests += batch[k].size_of_blocks;
+                warming = _line_count + _warmup_lines.size() < warmup_end_line ||
+                    pending_requests < warmup_end_request;
+                if (!warming || _warmup_lines.size() >= kWarmupChunk) {
+                    flush_warmup();
+                }
+            }
+            if (!warming) {
+                finish_warmup();
+                measure_start = std::chrono::steady_clock::now();
+                measured_from = _request_count;
+                if (_options.progress) {
+                    double s = std::chrono::duration<double>(measure_start - start_time).count();
+                    std::cout << "warm-up: " << _line_count << " lines, " << _request_count - first_request
+                        << " requests in " << s << "s (" << (_request_count - first_request) / std::max(s, 1e-9)
+                        << " req/s)" << std::endl;
+                }
+            }
+        }
+        for (; k < n; ++k) {
+            access_line(batch[k]);
+            ++_line_count;
+            if (_options.checkpoint_every > 0 && _line_count % _options.checkpoint_every == 0) {
+                write_checkpoint();
+            }
+            // 每100行输出一次进度信息和耗时信息，便于对比时间提升情况
+            if (_options.progress && _line_count % 100 == 0) {
+                auto current_time = std::chrono::steady_clock::now();
+                auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time).count();
+                std::cout << "Processed " << _line_count << " lines... "
+                    << "Elapsed time: " << elapsed / 60 << "m " << elapsed % 60 << "s\n";
+            }
+        }
+    }
+    if (warming) {
+        flush_warmup();
+        std::cerr << "trace ended during warm-up, no requests were measured" << std::endl;
+    }
+    else if (_options.progress && (warmup_end_request > first_request || warmup_lines > 0)) {
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - measure_start).count();
+        std::cout << "measured: " << _request_count - measured_from << " requests in " << s << "s ("
+            << (_request_count - measured_from) / std::max(s, 1e-9) << " req/s)" << std::endl;
+    }
+    // 最后一个不完整的窗口
+    if (_windowed && _request_count > _snapshot_request) {
+        take_snapshot(_last_time);
+    }
+    if (!_options.checkpoint_path.empty()) {
+        write_checkpoint();
+    }
+}
+
+void Simulator::write_checkpoint() {
+    std::string error;
+    if (!save_checkpoint(_options.checkpoint_path, &error)) {
+        std::cerr << "checkpoint failed: " << error << std::endl;
+    }
+}
+
+bool Simulator::save_checkpoint(const std::string& path, std::string* error) const {
+    snapshot_writer w;
+    w.begin("sim");
+    w.put<uint64_t>(_line_count);
+    w.put<uint64_t>(_request_count);
+    w.put<int32_t>(_ctx.period);
+    w.put<uint32_t>(static_cast<uint32_t>(_policies.size()));
+    for (const auto& p : _policies) {
+        w.put_string(p->name());
+        if (!p->save(w)) {
+            *error = std::string(p->name()) + " does not support snapshots";
+            return false;
+        }
+    }
+    if (!w.write_file(path)) {
+        *error = "can't write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool Simulator::load_checkpoint(const std::string& path, std::string* error) {
+    snapshot_reader r;
+    if (!r.read_file(path)) {
+        *error = "can't read " + path;
+        return false;
+    }
+    uint64_t lines = 0, requests = 0;
+    int32_t period = 0;
+    uint32_t count = 0;
+    if (!r.expect("sim") || !r.get(lines) || !r.get(requests) || !r.get(period) || !r.get(count)) {
+        *error = path + " is not a simulator checkpoint";
+        return false;
+    }
+    if (count != _policies.size()) {
+        *error = "checkpoint has a different number of policies";
+        return false;
+    }
+    for (auto& p : _policies) {
+        std::string name;
+        if (!r.get_string(name) || name != p->name()) {
+            *error = "checkpoint policy " + name + " does not match " + p->name();
+            return false;
+        }
+        if (!p->load(r)) {
+            *error = "can't restore " + name + " (different cache size or corrupt snapshot)";
+            return false;
+        }
+    }
+    _line_count = lines;
+    _request_count = requests;
+    _ctx.period = period;
+    _snapshot_request = requests;
+    _next_window_request = requests + _options.window_requests;
+    // 恢复出的累计值作为窗口基线，续跑后的第一个窗口不包含检查点之前的计数
+    for (size_t k = 0; k < _policies.size(); ++k) {
+        _snapshot[k] = _policies[k]->stats();
+    }
+    _series.set_baseline(_snapshot);
+    return true;
+}
+
+void Simulator::take_snapshot(time_t virtual_time) {
+    for (size_t k = 0; k < _policies.size(); ++k) {
+        _snapshot[k] = _policies[k]->stats();
+    }
+    _series.snapshot(_request_count, virtual_time, _ctx.period, _snapshot);
+    _snapshot_request = _request_count;
+}
+
+std::string Simulator::statics() {
+    std::string s;
+    for (auto& p : _policies) {
+        s += p->statics();
+    }
+    // 元数据内存：当前值、峰值、每个驻留对象的字节数，以及每 MB 元数据换来的命中率
+    for (auto& p : _policies) {
+        cache_stats st = p->stats();
+        double mb = st.metadata_bytes / (1024.0 * 1024.0);
+        double hit_rate = st.requests ? 1.0 * st.hits / st.requests : 0.0;
+        std::stringstream line;
+        line << "memory " << p->name() << ":"
+            << " metadata_bytes:" << st.metadata_bytes
+            << " peak:" << st.metadata_peak
+            << " bytes_per_entry:" << (st.resident ? 1.0 * st.metadata_bytes / st.resident : 0.0)
+            << " hit_rate_per_MB:" << (mb > 0 ? hit_rate / mb : 0.0) << std::endl;
+        s += line.str();
+    }
+    // 块命中率、按请求计的对象命中率与字节命中率，以及按后备存储代价模型估计的未命中总耗时
+    for (auto& p : _policies) {
+        cache_stats st = p->stats();
+        std::stringstream line;
+        line << "cost " << p->name() << ":"
+            << " hit_rate:" << (st.requests ? 1.0 * st.hits / st.requests : 0.0)
+            << " object_hit_rate:" << (st.object_requests ? 1.0 * st.object_hits / st.object_requests : 0.0)
+            << " byte_hit_rate:" << (st.bytes_requested > 0 ? st.bytes_hit / st.bytes_requested : 0.0)
+            << " miss_time_s:" << st.miss_time_us / 1e6 << std::endl;
+        s += line.str();
+    }
+    if (_options.latency_sample > 0) {
+        double ns_per_tick = _clock.ns_per_tick();
+        for (size_t k = 0; k < _policies.size(); ++k) {
+            s += _latency[k].report(_policies[k]->name(), ns_per_tick);
+        }
+    }
+    return s;
+}
+
+const std::vector<std::string>& default_policies() {
+    static const std::vector<std::string> names = {
+        "lru", "arc", "score", "tdc", "tdc_sketch", "wtinylfu_lru", "wtinylfu_arc",
+    };
+    return names;
+}
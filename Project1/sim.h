@@ -0,0 +1,102 @@
+#pragma once
+// 模拟循环：从 TraceSource 逐条读取请求，把每个块依次交给各策略
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "latency.h"
+#include "policy.h"
+#include "stats.h"
+#include "trace_source.h"
+
+const int kPeriodRequests = 160000;  // 每 160000 个块请求进入下一个 TDC 周期
+const double kBlockBytes = 4096;     // trace 中一个块的字节数
+
+// 系统当前时间（毫秒），SCORE 的访问记录用它打时间戳
+double wall_clock_ms();
+
+// 把一条请求展开成逐块访问：设置请求字节数、序号和末块标记，按需追加 SCORE 的访问记录，
+// 每 kPeriodRequests 块推进一次 TDC 周期。request 为跨行累计的块数，先计入当前块再调用 visit(block)
+template <class Visit>
+void for_each_block(const trace_line& l, SimContext& ctx, uint64_t& request, bool records, Visit visit) {
+    ctx.size = l.size_of_blocks * kBlockBytes;
+    ctx.request_number = l.request_number;
+    int end = l.starting_block + l.size_of_blocks;
+    for (int i = l.starting_block; i < end; ++i) {
+        ctx.last_block = i + 1 == end;
+        if (records) {
+            trace_line record = l;
+            record.current_time = static_cast<time_t>(wall_clock_ms());
+            ctx.trace_records.push_back(record);
+        }
+        if (request % kPeriodRequests == 0) {
+            ++ctx.period;
+        }
+        ++request;
+        visit(i);
+    }
+    if (records) {
+        ctx.trace_records.push_back(l);
+    }
+}
+
+struct SimOptions {
+    bool progress = true;  // 每 100 行输出一次进度和耗时，以及预热/测量阶段的吞吐
+    int latency_sample = 0;  // 每 N 次 get() 计时一次，0 表示不统计延迟
+    uint64_t window_requests = 0;  // 每 N 个请求做一次统计快照，0 表示不按请求数分窗
+    time_t window_time = 0;        // 每隔多少虚拟时间（trace 的 current_time）做一次快照，0 表示不按时间分窗
+    uint64_t warmup_requests = 0;  // 预热请求数：这部分只更新策略状态，结束时统计清零
+    double warmup_fraction = 0;    // 或按 trace 总行数的比例预热（需要能得知 trace 长度）
+    int warmup_threads = 0;        // 预热时并行处理的策略数，0 表示按硬件线程数
+    std::string checkpoint_path;   // 非空时在结束（以及每 checkpoint_every 行）写检查点
+    uint64_t checkpoint_every = 0;
+};
+
+class Simulator {
+public:
+    Simulator(std::vector<std::unique_ptr<CachePolicy>> policies, const SimOptions& options);
+
+    // 读完整个 trace
+    void run(TraceSource& source);
+    // 处理一条请求中的所有块
+    void access_line(trace_line& l);
+    // 检查点：模拟进度（行数、请求数、TDC 周期）+ 每个策略的计数器和状态。
+    // 加载后 run() 会先跳过已处理的行；延迟直方图和分窗序列从恢复点重新开始
+    bool save_checkpoint(const std::string& path, std::string* error) const;
+    bool load_checkpoint(const std::string& path, std::string* error);
+    // 各策略的统计信息和元数据内存占用，开启延迟统计时附带 p50/p99/p999/max
+    std::string statics();
+
+    uint64_t line_count() const { return _line_count; }
+    uint64_t request_count() const { return _request_count; }
+    const CachePolicy& policy(size_t k) const { return *_policies[k]; }
+    // 分窗快照，未开启分窗时为空
+    const stats_series& series() const { return _series; }
+
+private:
+    std::vector<std::unique_ptr<CachePolicy>> _policies;
+    SimOptions _options;
+    SimContext _ctx;
+    bool _records;            // 是否有策略需要 trace_records
+    uint64_t _line_count;
+    uint64_t _request_count;  // TDC 周期计数，跨行累计
+    std::vector<latency_stats_t> _latency;  // 与 _policies 一一对应
+    int _sample_countdown;
+    bool _windowed;
+    stats_series _series;
+    std::vector<cache_stats> _snapshot;  // 快照缓冲，避免每个窗口分配
+    uint64_t _next_window_request;
+    time_t _next_window_time;
+    uint64_t _snapshot_request;  // 上一次快照时的请求数
+    time_t _last_time;           // 最近一条请求的虚拟时间
+    std::vector<trace_line> _warmup_lines;  // 待预热的一段 trace
+    latency_clock_calibration _clock;
+
+    void take_snapshot(time_t virtual_time);
+    void write_checkpoint();
+    void flush_warmup();
+    void finish_warmup();
+};
+
+// main 默认运行的策略
+const std::vector<std::string>& default_policies();
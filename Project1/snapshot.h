@@ -0,0 +1,146 @@
+#pragma once
+// 紧凑二进制快照：写入时先在内存中拼好整段数据再一次写出；读取时一次顺序读入整个文件，
+// 再在内存里解析并批量重建索引。文件头为 "CPSN" + 版本号 + 类型名，字节序与本机一致
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "file_offset.h"
+
+inline const char* snapshot_magic() { return "CPSN"; }
+
+class snapshot_writer {
+public:
+    snapshot_writer() {}
+
+    // 写入文件头，kind 为快照类型（如 "lru"、"arc"）
+    void begin(const std::string& kind) {
+        put_bytes(snapshot_magic(), 4);
+        put<uint32_t>(kVersion);
+        put_string(kind);
+    }
+
+    template <class T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot_writer::put needs a trivially copyable type");
+        put_bytes(&v, sizeof(T));
+    }
+
+    void put_string(const std::string& s) {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        put_bytes(s.data(), s.size());
+    }
+
+    template <class T>
+    void put_vector(const std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot_writer::put_vector needs a trivially copyable type");
+        put<uint64_t>(v.size());
+        put_bytes(v.data(), v.size() * sizeof(T));
+    }
+
+    void put_bytes(const void* p, size_t n) {
+        const char* c = static_cast<const char*>(p);
+        _buf.insert(_buf.end(), c, c + n);
+    }
+
+    const std::vector<char>& data() const { return _buf; }
+
+    bool write_file(const std::string& path) const {
+        FILE* f = nullptr;
+        if (fopen_s(&f, path.c_str(), "wb") != 0 || !f) {
+            return false;
+        }
+        bool ok = fwrite(_buf.data(), 1, _buf.size(), f) == _buf.size();
+        return fclose(f) == 0 && ok;
+    }
+
+    enum { kVersion = 3 };
+
+private:
+    std::vector<char> _buf;
+};
+
+// 读取失败（文件截断、类型不符）后 ok() 为 false，后续读取都返回 false
+class snapshot_reader {
+public:
+    snapshot_reader() : _pos(0), _ok(true) {}
+
+    bool read_file(const std::string& path) {
+        FILE* f = nullptr;
+        if (fopen_s(&f, path.c_str(), "rb") != 0 || !f) {
+            return _ok = false;
+        }
+        uint64_t size = 0;
+        _ok = file_seek64(f, 0, SEEK_END) == 0 && (size = file_tell64(f)) != static_cast<uint64_t>(-1) &&
+            file_seek64(f, 0, SEEK_SET) == 0;
+        if (_ok) {
+            _buf.resize(static_cast<size_t>(size));
+            _ok = fread(_buf.data(), 1, _buf.size(), f) == _buf.size();
+        }
+        fclose(f);
+        _pos = 0;
+        return _ok;
+    }
+
+    // 校验文件头与快照类型
+    bool expect(const std::string& kind) {
+        char magic[4];
+        uint32_t version = 0;
+        std::string k;
+        if (!get_bytes(magic, 4) || std::memcmp(magic, snapshot_magic(), 4) != 0 ||
+            !get(version) || version != snapshot_writer::kVersion || !get_string(k) || k != kind) {
+            return _ok = false;
+        }
+        return true;
+    }
+
+    template <class T>
+    bool get(T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot_reader::get needs a trivially copyable type");
+        return get_bytes(&v, sizeof(T));
+    }
+
+    bool get_string(std::string& s) {
+        uint32_t n = 0;
+        if (!get(n) || !can_read(n)) {
+            return _ok = false;
+        }
+        s.assign(_buf.data() + _pos, n);
+        _pos += n;
+        return true;
+    }
+
+    template <class T>
+    bool get_vector(std::vector<T>& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot_reader::get_vector needs a trivially copyable type");
+        uint64_t n = 0;
+        if (!get(n) || n > (_buf.size() - _pos) / sizeof(T)) {
+            return _ok = false;
+        }
+        v.resize(static_cast<size_t>(n));
+        return get_bytes(v.data(), v.size() * sizeof(T));
+    }
+
+    bool get_bytes(void* p, size_t n) {
+        if (!can_read(n)) {
+            return _ok = false;
+        }
+        std::memcpy(p, _buf.data() + _pos, n);
+        _pos += n;
+        return true;
+    }
+
+    bool ok() const { return _ok; }
+
+private:
+    bool can_read(size_t n) const {
+        return _ok && n <= _buf.size() - _pos;
+    }
+
+    std::vector<char> _buf;
+    size_t _pos;
+    bool _ok;
+};
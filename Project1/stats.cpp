@@ -0,0 +1,111 @@
+#include "stats.h"
+#include <fstream>
+#include <sstream>
+
+stats_series::stats_series(const std::vector<std::string>& policy_names, size_t reserve_windows) :
+    _names(policy_names) {
+    _rows.reserve(reserve_windows);
+    _samples.reserve(reserve_windows * _names.size());
+}
+
+void stats_series::snapshot(uint64_t request_count, time_t virtual_time, int period,
+    const std::vector<cache_stats>& stats) {
+    _rows.push_back(row{ request_count, virtual_time, period });
+    _samples.insert(_samples.end(), stats.begin(), stats.end());
+}
+
+// emit(窗口号, 行, 策略序号, 窗口内增量, 窗口末累计值)
+template <class Emit>
+void stats_series::for_each_window(Emit emit) const {
+    const size_t n = _names.size();
+    cache_stats zero;
+    for (size_t w = 0; w < _rows.size(); ++w) {
+        for (size_t k = 0; k < n; ++k) {
+            const cache_stats& cur = _samples[w * n + k];
+            const cache_stats& prev = w > 0 ? _samples[(w - 1) * n + k] : _baseline.empty() ? zero : _baseline[k];
+            cache_stats d;
+            d.requests = cur.requests - prev.requests;
+            d.hits = cur.hits - prev.hits;
+            d.object_requests = cur.object_requests - prev.object_requests;
+            d.object_hits = cur.object_hits - prev.object_hits;
+            d.bytes_requested = cur.bytes_requested - prev.bytes_requested;
+            d.bytes_hit = cur.bytes_hit - prev.bytes_hit;
+            d.miss_time_us = cur.miss_time_us - prev.miss_time_us;
+            d.evictions = cur.evictions - prev.evictions;
+            d.resident = cur.resident;
+            d.metadata_bytes = cur.metadata_bytes;
+            d.metadata_peak = cur.metadata_peak;
+            emit(w, _rows[w], k, d, cur);
+        }
+    }
+}
+
+namespace {
+
+double ratio(double a, double b) {
+    return b > 0 ? a / b : 0.0;
+}
+
+} // namespace
+
+std::string stats_series::to_csv() const {
+    std::stringstream s;
+    s << "window,policy,request_end,virtual_time,period,requests,hits,hit_rate,object_hit_rate,byte_hit_rate,miss_time_us,"
+        << "evictions,resident,metadata_bytes,metadata_peak,bytes_per_entry,cum_hit_rate\n";
+    for_each_window([&](size_t w, const row& r, size_t k, const cache_stats& d, const cache_stats& cur) {
+        s << w << ',' << _names[k] << ',' << r.request_count << ',' << r.virtual_time << ',' << r.period
+            << ',' << d.requests << ',' << d.hits
+            << ',' << ratio(static_cast<double>(d.hits), static_cast<double>(d.requests))
+            << ',' << ratio(static_cast<double>(d.object_hits), static_cast<double>(d.object_requests))
+            << ',' << ratio(d.bytes_hit, d.bytes_requested)
+            << ',' << d.miss_time_us
+            << ',' << d.evictions << ',' << d.resident
+            << ',' << d.metadata_bytes << ',' << d.metadata_peak
+            << ',' << ratio(static_cast<double>(d.metadata_bytes), static_cast<double>(d.resident))
+            << ',' << ratio(static_cast<double>(cur.hits), static_cast<double>(cur.requests)) << '\n';
+    });
+    return s.str();
+}
+
+std::string stats_series::to_json() const {
+    std::stringstream s;
+    s << "{\n  \"policies\": [";
+    for (size_t k = 0; k < _names.size(); ++k) {
+        s << (k ? ", " : "") << '"' << _names[k] << '"';
+    }
+    s << "],\n  \"windows\": [";
+    bool first = true;
+    for_each_window([&](size_t w, const row& r, size_t k, const cache_stats& d, const cache_stats& cur) {
+        s << (first ? "\n" : ",\n");
+        first = false;
+        s << "    {\"window\": " << w << ", \"policy\": \"" << _names[k] << '"'
+            << ", \"request_end\": " << r.request_count
+            << ", \"virtual_time\": " << r.virtual_time
+            << ", \"period\": " << r.period
+            << ", \"requests\": " << d.requests
+            << ", \"hits\": " << d.hits
+            << ", \"hit_rate\": " << ratio(static_cast<double>(d.hits), static_cast<double>(d.requests))
+            << ", \"object_hit_rate\": " << ratio(static_cast<double>(d.object_hits), static_cast<double>(d.object_requests))
+            << ", \"byte_hit_rate\": " << ratio(d.bytes_hit, d.bytes_requested)
+            << ", \"miss_time_us\": " << d.miss_time_us
+            << ", \"evictions\": " << d.evictions
+            << ", \"resident\": " << d.resident
+            << ", \"metadata_bytes\": " << d.metadata_bytes
+            << ", \"metadata_peak\": " << d.metadata_peak
+            << ", \"bytes_per_entry\": " << ratio(static_cast<double>(d.metadata_bytes), static_cast<double>(d.resident))
+            << ", \"cum_hit_rate\": " << ratio(static_cast<double>(cur.hits), static_cast<double>(cur.requests))
+            << '}';
+    });
+    s << "\n  ]\n}\n";
+    return s.str();
+}
+
+bool stats_series::write(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    out << (json ? to_json() : to_csv());
+    return static_cast<bool>(out);
+}
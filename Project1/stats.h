@@ -0,0 +1,103 @@
+#pragma once
+// 结构化统计：每个策略暴露一组累计计数器，模拟器按窗口对其做快照，结束时导出 CSV/JSON
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// 某一时刻的累计计数（从模拟开始算起）。requests/hits 按块计；
+// object_* 与 bytes_* 按请求（trace 行）计，请求的所有块都命中才算命中，字节为整个请求的大小
+struct cache_stats {
+    uint64_t requests = 0;
+    uint64_t hits = 0;
+    uint64_t object_requests = 0;
+    uint64_t object_hits = 0;
+    double bytes_requested = 0;
+    double bytes_hit = 0;
+    uint64_t evictions = 0;
+    uint64_t resident = 0;       // 当前驻留对象数（快照值，不累计）
+    uint64_t metadata_bytes = 0; // 策略当前占用的堆内存（快照值）
+    uint64_t metadata_peak = 0;  // 策略堆内存峰值（含淘汰时的临时表）
+    double miss_time_us = 0;     // 按 miss_cost_model 估计的未命中总耗时
+};
+
+// 后备存储的未命中代价：固定开销（寻道、网络往返）加传输时间，默认值相当于机械盘
+struct miss_cost_model {
+    double fixed_us = 5000;
+    double bandwidth_mb = 150;  // 1 MB/s 即每微秒 1 字节
+
+    double cost_us(double bytes) const {
+        return fixed_us + (bandwidth_mb > 0 ? bytes / bandwidth_mb : 0.0);
+    }
+    // 一个请求的代价均摊到它的每个块上
+    double block_cost_us(double request_bytes) const {
+        return cost_us(request_bytes) / request_blocks(request_bytes);
+    }
+
+    // 请求按 4096 字节一块折算的块数，不足一块按一块计
+    static double request_blocks(double request_bytes) {
+        return request_bytes > 4096 ? request_bytes / 4096 : 1.0;
+    }
+};
+
+// 把逐块的命中结果汇总到请求上：last_block 为 true 时结算当前请求
+class request_tally {
+public:
+    request_tally() : _missed(false) {}
+
+    void add(cache_stats& s, bool hit, double request_bytes, bool last_block) {
+        _missed = _missed || !hit;
+        if (!last_block) {
+            return;
+        }
+        ++s.object_requests;
+        s.bytes_requested += request_bytes;
+        if (!_missed) {
+            ++s.object_hits;
+            s.bytes_hit += request_bytes;
+        }
+        _missed = false;
+    }
+    void clear() { _missed = false; }
+
+private:
+    bool _missed;  // 当前请求已有块未命中
+};
+
+// 窗口序列：每个窗口结束时记录一行（所有策略的累计值），导出时再做差得到窗口内的值
+class stats_series {
+public:
+    // reserve_windows：预分配的窗口数，超出后按 vector 规则扩容
+    stats_series(const std::vector<std::string>& policy_names, size_t reserve_windows = 1024);
+
+    // 记录一个窗口边界；stats 与构造时的策略顺序一致
+    void snapshot(uint64_t request_count, time_t virtual_time, int period,
+        const std::vector<cache_stats>& stats);
+
+    // 第一个窗口之前的累计值（从检查点恢复时为恢复出的计数），第一个窗口只统计其后的增量
+    void set_baseline(const std::vector<cache_stats>& stats) { _baseline = stats; }
+
+    size_t window_count() const { return _rows.size(); }
+
+    // 每行一个 (窗口, 策略)：窗口内命中率（按块）、对象命中率与字节命中率（按请求）、未命中耗时、淘汰数，以及窗口末的驻留对象数和内存占用
+    std::string to_csv() const;
+    std::string to_json() const;
+    // 按扩展名选择格式（.json 为 JSON，其余为 CSV），失败返回 false
+    bool write(const std::string& path) const;
+
+private:
+    struct row {
+        uint64_t request_count;
+        time_t virtual_time;
+        int period;
+    };
+
+    template <class Emit>
+    void for_each_window(Emit emit) const;
+
+    std::vector<std::string> _names;
+    std::vector<row> _rows;
+    std::vector<cache_stats> _samples;  // _rows.size() * _names.size()，按行连续存放
+    std::vector<cache_stats> _baseline; // 为空表示从 0 开始
+};
@@ -0,0 +1,334 @@
+#include "sweep.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "policy.h"
+#include "sim.h"
+#include "trace_source.h"
+
+namespace {
+
+struct sweep_options {
+    std::vector<std::string> traces;
+    std::vector<std::string> policies;
+    std::vector<int> sizes;
+    int threads = 0;  // 0 表示按硬件线程数
+    uint64_t warmup_requests = 0;
+    double warmup_fraction = 0;
+    std::string out;
+};
+
+// 解码后的 trace，所有任务共享同一份只读记录
+struct loaded_trace {
+    std::string name;
+    std::vector<trace_line> lines;
+    uint64_t requests;  // 块访问总数
+};
+
+struct sweep_job {
+    size_t trace;
+    std::string policy;
+    int cache_size;
+    size_t index;   // 在结果表中的位置（按网格顺序）
+    double cost;    // 估计耗时，只用于排序
+};
+
+struct sweep_result {
+    std::string trace;
+    std::string policy;
+    int cache_size;
+    cache_stats stats;
+    double seconds;
+};
+
+std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            out.push_back(item);
+        }
+    }
+    return out;
+}
+
+// 估计任务耗时：与请求数成正比；SCORE 每次未命中扫描全部 trace_records，
+// TDC 和 Ceph 分层缓存每次淘汰扫描 O(c) 个对象，这几种按缓存大小再加权
+double estimate_cost(const std::string& policy, int c, uint64_t requests) {
+    double r = static_cast<double>(requests);
+    if (policy == "score") {
+        return r * r;
+    }
+    if (policy == "tdc" || policy == "ceph_tier") {
+        return r * c;
+    }
+    if (policy == "tdc_sketch") {
+        return r * 64;
+    }
+    return r;
+}
+
+/**
+ * 工作窃取队列：每个工作线程一个双端队列，任务按估计耗时从大到小轮流分配。
+ * 线程从自己队列的头部取（最长的任务），自己的队列空了再从其他队列尾部偷（最短的任务），
+ * 网格末尾只剩短任务时各线程仍能互相补位
+ */
+class steal_queues {
+public:
+    explicit steal_queues(size_t workers) : _queues(workers), _locks(workers) {}
+
+    void push(size_t worker, const sweep_job& job) {
+        _queues[worker].push_back(job);
+    }
+
+    bool pop(size_t worker, sweep_job& job) {
+        {
+            std::lock_guard<std::mutex> g(_locks[worker]);
+            if (!_queues[worker].empty()) {
+                job = _queues[worker].front();
+                _queues[worker].pop_front();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < _queues.size(); ++k) {
+            size_t victim = (worker + k) % _queues.size();
+            std::lock_guard<std::mutex> g(_locks[victim]);
+            if (!_queues[victim].empty()) {
+                job = _queues[victim].back();
+                _queues[victim].pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::deque<sweep_job>> _queues;
+    std::vector<std::mutex> _locks;
+};
+
+bool load_trace(const std::string& name, loaded_trace& t) {
+    std::unique_ptr<TraceSource> source = open_trace(name);
+    if (!source) {
+        return false;
+    }
+    t.name = name;
+    t.requests = 0;
+    uint64_t n = source->length();
+    if (n > 0) {
+        t.lines.reserve(static_cast<size_t>(n));
+    }
+    trace_line l;
+    while (source->next(l)) {
+        t.lines.push_back(l);
+        t.requests += l.size_of_blocks;
+    }
+    return true;
+}
+
+sweep_result run_job(const sweep_job& job, const loaded_trace& t, const sweep_options& opt) {
+    std::vector<std::unique_ptr<CachePolicy>> policies;
+    policies.push_back(make_policy(job.policy, job.cache_size, t.name));
+    SimOptions options;
+    options.progress = false;
+    options.warmup_requests = opt.warmup_requests;
+    options.warmup_fraction = opt.warmup_fraction;
+    options.warmup_threads = 1;  // 并行度由线程池提供
+    Simulator sim(std::move(policies), options);
+    MemoryTraceSource source(t.lines);
+
+    auto start = std::chrono::steady_clock::now();
+    sim.run(source);
+    sweep_result r;
+    r.trace = t.name;
+    r.policy = job.policy;
+    r.cache_size = job.cache_size;
+    r.stats = sim.policy(0).stats();
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+double safe_ratio(double a, double b) {
+    return b > 0 ? a / b : 0.0;
+}
+
+// 合成 trace 的规格里有逗号，CSV 字段需要加引号
+std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"") == std::string::npos) {
+        return s;
+    }
+    std::string q = "\"";
+    for (char ch : s) {
+        q += ch;
+        if (ch == '"') {
+            q += ch;
+        }
+    }
+    return q + "\"";
+}
+
+void write_table(std::ostream& os, const std::vector<sweep_result>& results) {
+    os << "trace,policy,cache_size,requests,hits,hit_rate,object_hit_rate,byte_hit_rate,evictions,"
+        << "metadata_bytes,metadata_peak,seconds\n";
+    for (const auto& r : results) {
+        const cache_stats& s = r.stats;
+        os << csv_field(r.trace) << ',' << r.policy << ',' << r.cache_size
+            << ',' << s.requests << ',' << s.hits
+            << ',' << safe_ratio(static_cast<double>(s.hits), static_cast<double>(s.requests))
+            << ',' << safe_ratio(static_cast<double>(s.object_hits), static_cast<double>(s.object_requests))
+            << ',' << safe_ratio(s.bytes_hit, s.bytes_requested)
+            << ',' << s.evictions << ',' << s.metadata_bytes << ',' << s.metadata_peak
+            << ',' << r.seconds << '\n';
+    }
+}
+
+void usage(const char* prog) {
+    std::cerr << "usage: " << prog << " --sweep --traces t1,t2,... [--trace synth:<spec> ...] --sizes c1,c2,...\n"
+        << "                 [--policies p1,p2,...] [--threads N] [--warmup N|P%] [--out table.csv]\n"
+        << "       every (trace, policy, size) runs once; each trace is decoded once and shared\n";
+}
+
+} // namespace
+
+int run_sweep(int argc, char** argv) {
+    sweep_options opt;
+    opt.policies = default_policies();
+    for (int i = 2; i < argc; ++i) {  // argv[1] 是 --sweep
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--traces") {
+            for (const auto& t : split(value)) {
+                opt.traces.push_back(t);
+            }
+        }
+        else if (arg == "--trace") {
+            // 单个 trace，可重复；合成规格本身含逗号时用它
+            opt.traces.push_back(value);
+        }
+        else if (arg == "--policies") {
+            opt.policies = split(value);
+        }
+        else if (arg == "--sizes") {
+            opt.sizes.clear();
+            for (const auto& s : split(value)) {
+                opt.sizes.push_back(std::stoi(s));
+            }
+        }
+        else if (arg == "--threads") {
+            opt.threads = std::stoi(value);
+        }
+        else if (arg == "--warmup") {
+            if (!value.empty() && value.back() == '%') {
+                opt.warmup_fraction = std::stod(value.substr(0, value.size() - 1)) / 100.0;
+            }
+            else {
+                opt.warmup_requests = std::stoull(value);
+            }
+        }
+        else if (arg == "--out") {
+            opt.out = value;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opt.traces.empty() || opt.sizes.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (const auto& policy : opt.policies) {
+        if (!make_policy(policy, 1, "sweep")) {
+            std::cerr << "unknown policy: " << policy << std::endl;
+            return 1;
+        }
+    }
+
+    // 每个 trace 只解码一次
+    std::vector<loaded_trace> traces(opt.traces.size());
+    for (size_t t = 0; t < opt.traces.size(); ++t) {
+        if (!load_trace(opt.traces[t], traces[t])) {
+            std::cerr << "can't open trace " << opt.traces[t] << std::endl;
+            return -1;
+        }
+        std::cerr << "loaded " << traces[t].name << ": " << traces[t].lines.size() << " lines, "
+            << traces[t].requests << " requests" << std::endl;
+    }
+
+    std::vector<sweep_job> jobs;
+    for (size_t t = 0; t < traces.size(); ++t) {
+        for (const auto& policy : opt.policies) {
+            for (int c : opt.sizes) {
+                jobs.push_back(sweep_job{ t, policy, c, jobs.size(), estimate_cost(policy, c, traces[t].requests) });
+            }
+        }
+    }
+    // 长任务先开始，避免网格末尾一个长任务拖住所有线程
+    std::stable_sort(jobs.begin(), jobs.end(), [](const sweep_job& a, const sweep_job& b) {
+        return a.cost > b.cost;
+    });
+
+    size_t workers = opt.threads > 0 ? static_cast<size_t>(opt.threads)
+        : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, jobs.size());
+    steal_queues queues(workers);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        queues.push(i % workers, jobs[i]);
+    }
+
+    std::vector<sweep_result> results(jobs.size());
+    std::atomic<size_t> done(0);
+    std::mutex log_lock;
+    auto start = std::chrono::steady_clock::now();
+    auto work = [&](size_t worker) {
+        sweep_job job;
+        while (queues.pop(worker, job)) {
+            sweep_result r = run_job(job, traces[job.trace], opt);
+            size_t finished = ++done;
+            {
+                std::lock_guard<std::mutex> g(log_lock);
+                std::cerr << "[" << finished << "/" << jobs.size() << "] " << r.trace << " " << r.policy
+                    << " cache_size:" << r.cache_size << " hit_rate:"
+                    << safe_ratio(static_cast<double>(r.stats.hits), static_cast<double>(r.stats.requests))
+                    << " " << r.seconds << "s" << std::endl;
+            }
+            results[job.index] = std::move(r);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(work, w);
+    }
+    work(0);
+    for (auto& t : pool) {
+        t.join();
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "sweep: " << jobs.size() << " runs on " << workers << " threads in " << s << "s" << std::endl;
+
+    if (opt.out.empty()) {
+        write_table(std::cout, results);
+    }
+    else {
+        std::ofstream os(opt.out);
+        if (!os) {
+            std::cerr << "can't open " << opt.out << std::endl;
+            return -1;
+        }
+        write_table(os, results);
+    }
+    return 0;
+}
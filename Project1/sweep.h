@@ -0,0 +1,4 @@
+#pragma once
+// 参数扫描：SCORE.exe --sweep --traces t1,t2 [--trace synth:<规格>] --policies p1,p2 --sizes c1,c2 [选项]
+// 在工作窃取线程池上运行 (trace, 策略, 缓存大小) 网格中的每个组合，结果汇总为一张表
+int run_sweep(int argc, char** argv);
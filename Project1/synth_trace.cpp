@@ -0,0 +1,207 @@
+#include "synth_trace.h"
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        out.push_back(item);
+    }
+    return out;
+}
+
+} // namespace
+
+bool SyntheticTraceSource::parse(const std::string& spec, std::string* error) {
+    std::string streams = spec;
+    _limit = 1000000;
+    size_t at = spec.rfind('@');
+    if (at != std::string::npos) {
+        streams = spec.substr(0, at);
+        _limit = std::stoull(spec.substr(at + 1));
+    }
+
+    uint64_t base = 0;
+    double total_weight = 0;
+    std::vector<double> weights;
+    std::vector<std::string> parts = split(streams, '+');
+    for (size_t i = 0; i < parts.size(); ++i) {
+        std::vector<std::string> fields = split(parts[i], ',');
+        WorkloadKind kind;
+        double alpha;
+        if (fields.empty() || !KeyStream::parse(fields[0], &kind, &alpha)) {
+            *error = "unknown pattern in '" + parts[i] + "'";
+            return false;
+        }
+        uint64_t keys = 100000;
+        uint64_t seed = 42 + i;
+        double weight = 1.0;
+        tenant t;
+        t.sizes = SIZE_FIXED;
+        t.size_min = t.size_max = 1;
+        t.size_p = 0;
+        t.shift_at = 0;
+        for (size_t f = 1; f < fields.size(); ++f) {
+            size_t eq = fields[f].find('=');
+            if (eq == std::string::npos) {
+                *error = "expected key=value, got '" + fields[f] + "'";
+                return false;
+            }
+            std::string key = fields[f].substr(0, eq);
+            std::string value = fields[f].substr(eq + 1);
+            if (key == "keys") {
+                keys = static_cast<uint64_t>(std::stod(value));
+            }
+            else if (key == "seed") {
+                seed = std::stoull(value);
+            }
+            else if (key == "weight") {
+                weight = std::stod(value);
+            }
+            else if (key == "shift") {
+                t.shift_at = static_cast<uint64_t>(std::stod(value));
+            }
+            else if (key == "size") {
+                size_t dash = value.find('-');
+                if (value.compare(0, 3, "geo") == 0) {
+                    double mean = std::stod(value.substr(3));
+                    t.sizes = SIZE_GEO;
+                    t.size_min = 1;
+                    t.size_max = INT_MAX / 2;
+                    t.size_p = mean > 1 ? std::log(1.0 - 1.0 / mean) : 0;
+                }
+                else if (dash != std::string::npos) {
+                    t.sizes = SIZE_UNIFORM;
+                    t.size_min = std::stoi(value.substr(0, dash));
+                    t.size_max = std::stoi(value.substr(dash + 1));
+                }
+                else {
+                    t.size_min = t.size_max = std::stoi(value);
+                }
+                if (t.size_min < 1 || t.size_max < t.size_min) {
+                    *error = "bad size '" + value + "'";
+                    return false;
+                }
+            }
+            else {
+                *error = "unknown option '" + key + "'";
+                return false;
+            }
+        }
+        t.stream.reset(new KeyStream(kind, keys, alpha, seed));
+        t.base = static_cast<int>(base);
+        base += t.stream->span();
+        if (base > INT_MAX) {
+            *error = "key space exceeds int range";
+            return false;
+        }
+        t.span = static_cast<int>(t.stream->span());
+        total_weight += weight;
+        weights.push_back(weight);
+        _tenants.push_back(std::move(t));
+    }
+
+    double acc = 0;
+    for (double w : weights) {
+        acc += w / total_weight;
+        _cumulative.push_back(acc);
+    }
+    _cumulative.back() = 1.0;
+    return true;
+}
+
+int SyntheticTraceSource::sample_size(const tenant& t) {
+    switch (t.sizes) {
+    case SIZE_UNIFORM:
+        return t.size_min + static_cast<int>(_rng.next_below(t.size_max - t.size_min + 1));
+    case SIZE_GEO:
+        if (t.size_p == 0) {
+            return 1;
+        }
+        return 1 + static_cast<int>(std::log(1.0 - _rng.next_double()) / t.size_p);
+    case SIZE_FIXED:
+    default:
+        return t.size_min;
+    }
+}
+
+inline void SyntheticTraceSource::fill(trace_line& l) {
+    size_t idx = 0;
+    if (_tenants.size() > 1) {
+        double u = _rng.next_double();
+        while (u >= _cumulative[idx]) {
+            ++idx;
+        }
+    }
+    tenant& t = _tenants[idx];
+    if (t.shift_at != 0 && _count >= t.shift_at) {
+        t.stream->shift_hot_set();
+        t.shift_at = 0;
+    }
+    int offset = t.stream->next();
+    l.starting_block = t.base + offset;
+    l.size_of_blocks = clamp_size(t, offset, t.size_min == t.size_max ? t.size_min : sample_size(t));
+    l.ignore = 0;
+    l.request_number = static_cast<int>(_count);
+    l.access_count = 0;
+    l.current_time = static_cast<time_t>(_count);  // 虚拟时间：请求序号
+    ++_count;
+}
+
+bool SyntheticTraceSource::next(trace_line& l) {
+    if (_count >= _limit) {
+        return false;
+    }
+    fill(l);
+    return true;
+}
+
+size_t SyntheticTraceSource::next_batch(trace_line* out, size_t n) {
+    uint64_t left = _limit - _count;
+    if (n > left) {
+        n = static_cast<size_t>(left);
+    }
+    if (_tenants.size() == 1) {
+        fill_single(out, n);
+        return n;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        fill(out[i]);
+    }
+    return n;
+}
+
+void SyntheticTraceSource::fill_single(trace_line* out, size_t n) {
+    tenant& t = _tenants[0];
+    KeyStream& stream = *t.stream;
+    size_t done = 0;
+    while (done < n) {
+        if (t.shift_at != 0 && _count >= t.shift_at) {
+            stream.shift_hot_set();
+            t.shift_at = 0;
+        }
+        size_t run = n - done;
+        if (t.shift_at != 0 && t.shift_at - _count < run) {
+            run = static_cast<size_t>(t.shift_at - _count);
+        }
+        trace_line* l = out + done;
+        stream.generate(run, [l](size_t i, int key) { l[i].starting_block = key; });
+        bool fixed = t.size_min == t.size_max;
+        for (size_t i = 0; i < run; ++i) {
+            int offset = l[i].starting_block;
+            l[i].starting_block = t.base + offset;
+            l[i].size_of_blocks = clamp_size(t, offset, fixed ? t.size_min : sample_size(t));
+            l[i].ignore = 0;
+            l[i].request_number = static_cast<int>(_count + i);
+            l[i].access_count = 0;
+            l[i].current_time = static_cast<time_t>(_count + i);
+        }
+        _count += run;
+        done += run;
+    }
+}
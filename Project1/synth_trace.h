@@ -0,0 +1,55 @@
+#pragma once
+// 流式合成 trace：按需逐条生成 trace_line，不写文件、不缓存整条 trace
+//
+// 规格：synth:<流>[+<流>...][@<请求数>]
+//   流：<uniform|zipf<alpha>|scan|loop|mixed>[,keys=N][,size=A|A-B|geo<均值>][,weight=W][,shift=T][,seed=S]
+//   keys   热点集合大小（默认 100000）
+//   size   size_of_blocks 分布：固定值、[A,B] 均匀或几何分布（默认 1）
+//   weight 多租户交织时的请求占比（默认 1）
+//   shift  第 T 个请求后热点集合迁移
+// 例：synth:zipf0.9,keys=1000000,size=1-8,shift=5000000+scan,keys=200000,weight=0.2@10000000
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "trace_source.h"
+#include "workload.h"
+
+class SyntheticTraceSource : public TraceSource {
+public:
+    SyntheticTraceSource() : _rng(7), _limit(0), _count(0) {}
+
+    bool parse(const std::string& spec, std::string* error);
+    bool next(trace_line& l) override;
+    size_t next_batch(trace_line* out, size_t n) override;
+    uint64_t length() override { return _limit; }
+
+private:
+    enum size_kind { SIZE_FIXED, SIZE_UNIFORM, SIZE_GEO };
+    struct tenant {
+        std::unique_ptr<KeyStream> stream;
+        int base;               // 租户键空间起点，各租户互不重叠
+        int span;               // 租户键空间大小，请求的块范围不超出 [base, base + span)
+        size_kind sizes;
+        int size_min;
+        int size_max;
+        double size_p;          // 几何分布：log(1 - 1/均值)
+        uint64_t shift_at;      // 0 表示不迁移
+    };
+
+    inline void fill(trace_line& l);
+    // 单租户批量生成：先连续生成块号，再填其余字段，热点迁移点把批次切开
+    void fill_single(trace_line* out, size_t n);
+    int sample_size(const tenant& t);
+    // 大小截断到租户键空间末尾，多块请求不会落到下一个租户的块上
+    static int clamp_size(const tenant& t, int offset, int size) {
+        int room = t.span - offset;
+        return size < room ? size : room;
+    }
+
+    std::vector<tenant> _tenants;
+    std::vector<double> _cumulative;  // 按权重累积的选择概率
+    FastRng _rng;
+    uint64_t _limit;
+    uint64_t _count;
+};
@@ -1,4 +1,5 @@
 #include "tdc2.h"
+#include "density_kernel.h"
 #include <cassert> 
 #include <iostream>
 #include <chrono>
@@ -23,152 +24,110 @@ uint32_t tdcCache::get_grade(unsigned i) const {
 
 bool tdcCache::get(int oid, int size) {
     ++_get_count;//
-    object_c obj(oid, size);
+    ++_clock;
     //黺
-    if (obj_map.find(oid) != obj_map.end()) {
+    if (_objects.contains(oid)) {
         ++_hit_count;
-        hit_set->setBit(obj.oid);
+        hit_set->setBit(oid);
         return true;
     }
     //µǰС
-    _current_size += obj.size;
+    _current_size += size;
     if (_current_size > _capacity) {
         //ܽл
         agent_work();
     }
-    obj_set.push_front(obj);
-    obj_map[oid] = obj_set.begin();// obj_mapиλá
+    _objects.insert(oid, size, static_cast<int64_t>(_clock));
     // hit_setøöλʾ
-    hit_set->setBit(obj.oid);
+    hit_set->setBit(oid);
     //hit_setʣ㣬renew_hit_set()»ˢhit_set
     if (hit_set->remain_capacity() <= 0) {
         renew_hit_set();
     }
-    //һԣȷobj_mapobj_setĴСһ£ݽṹһԡ
-    assert(obj_map.size() == obj_set.size());
     return true;
 }
-// objects_list_partial ȡһֶȻ agent_maybe_evict Ƿ̭Щ
+// objects_list_partial ѡһѡȻ agent_maybe_evict Ƿ̭Щ
 // ִдĹѡһֶ̭飬Ƿɹִй
 
 bool tdcCache::agent_work() {
-    vector<list<object_c>::iterator> ls;//һΪls
-    int selectedCount = objects_list_partial(ls);
-    if (selectedCount > 0) {
-       
-        // ӡ ls еĶϢ
-        std::cout << "Objects in ls after maybe_evict:" << std::endl;
-        for (auto it = ls.begin(); it != ls.end(); ++it) {
-            // õԷ object_c 󣬲ӡϢ
-            object_c& obj = **it; // ע˫ؽãΪ ls 洢ָ list жĵ
-            std::cout << "Object ID: " << obj.oid << ", Size: " << obj.size << std::endl;
-        }
-        return agent_maybe_evict(ls); // شǷɹִй
+    if (objects_list_partial() > 0) {
+        return agent_maybe_evict(); // شǷɹִй
     }
     return false; // ûѡκζ򷵻falseʾδɹִ
 }
 //ǷҪӻ̭һЩݶġ¶ȡʹСܶȣȻƽܶȽбȽϣƽܶȵĶܱ̭
-bool tdcCache::agent_maybe_evict(vector<list<object_c>::iterator>& ls) {
-    vector<pair<int, list<object_c>::iterator>> v;
-    uint64_t dentisy_sum = 0;
-
-    for (int i = 0; i < ls.size(); ++i) {
-        auto now = system_clock::now();
-        auto obj_local_mtime = ls[i]->mtime;
-
-        std::time_t mtime_t = std::chrono::system_clock::to_time_t(obj_local_mtime);
-        char buffer[26]; // ctime_s Ҫһ㹻Ļ洢ַ
-        errno_t err = ctime_s(buffer, sizeof(buffer), &mtime_t);
-        if (err == 0) {
-            std::cout << "mtime: " << buffer;
-        }
-        else {
-            std::cerr << "Error formatting time\n";
-        }
-        // ʱжǷ
-        if (obj_local_mtime + seconds(static_cast<long long>(cache_min_evict_age)) > now) {
-            // ̫ᡱ
-            continue;
-        }
-
-        int temp = 0;
-        if (hit_set)
-            agent_estimate_temp(ls[i], &temp);
-
-        // ʱתΪ
-        auto duration = duration_cast<seconds>(now - obj_local_mtime).count();
-        std::cout << "Duration: " << duration << " seconds" << std::endl;
-
-        int density = 0;
-        if (ls[i]->size * duration != 0) { // 
-            density = temp / (ls[i]->size * duration);
-        }
-        else {
-            std::cout << "Warning: division by zero (size * duration is 0)." << std::endl;
-            continue; // ѡѭ
-        }
-
-        dentisy_sum += density;
-
-        v.push_back({ density, ls[i] });
+//Ϊķʴ̫Ϊ 0 ĺѡƽ̭
+bool tdcCache::agent_maybe_evict() {
+    size_t n = _cand.count;
+    if (hit_set) {
+        agent_estimate_temp();
     }
-    std::cout << "Size of v: " << v.size() << std::endl; // ӡ v ĴС
-    uint64_t density_avg = dentisy_sum / v.size();
-
-    for (int i = 0; i < v.size(); ++i) {
-        if (v[i].first > density_avg) {
+    else {
+        fill(_cand.temp.begin(), _cand.temp.begin() + n, 0);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        _cand.age[i] = static_cast<int32_t>(min<uint64_t>(_clock - static_cast<uint64_t>(_cand.mtime[i]), INT32_MAX));
+    }
+    density_summary r = score_density(_cand.temp.data(), _cand.size.data(), _cand.age.data(),
+        cache_min_evict_age, n, _cand.density.data(), _cand.mask.data());
+    // кѡ߶ʱûп̭Ķ
+    if (r.valid == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (!_cand.mask[i]) {
             continue;
         }
-        auto it = v[i].second;
-        if (obj_map.find(it->oid) == obj_map.end()) {
-            return false;
+        // ʱͬһܳΣѱ̭
+        int64_t s = _objects.find(_cand.oid[i]);
+        if (s < 0) {
+            continue;
         }
-        _current_size -= it->size;
-        auto temp_it = obj_map[it->oid];
-        obj_map.erase(it->oid);
-        _next = obj_set.erase(temp_it);
+        _current_size -= _objects.size[s];
+        _objects.remove(static_cast<uint32_t>(s));
+        ++_eviction_count;
     }
+    return true;
 }
 
-//ӻѡһֶ̭顣
-int tdcCache::objects_list_partial(vector<list<object_c>::iterator>& ls) {
-    // Ϊգֱӷ
-    if (obj_set.empty()) {
-        ls.clear(); // ȷӳĵǰ״̬
-        return 0; // ûѡеĶ
-    }
-
-    int n = max(1, static_cast<int>(obj_map.size() * osd_pool_default_cache_max_evict_check_size));
-    ls.resize(n);
-    int selectedCount = 0; // ڼ¼ѡĶ
-
-    for (int i = 0; i < n; ++i) {
-        if (_next == obj_set.end()) {
-            _next = obj_set.begin();
-        }
-
-        // ﲻҪټ _next != obj_set.end()ΪѾΪյ
-        ls[i] = _next;
-        ++_next;
-        ++selectedCount;
-    }
-
-    return selectedCount;
+//ӻѡһֶ̭飬ԪݰиƵ _cand
+int tdcCache::objects_list_partial() {
+    size_t n = max<size_t>(min_evict_check, static_cast<size_t>(_objects.count() * osd_pool_default_cache_max_evict_check_size));
+    _cand.resize(n);
+    _cand.resize(_objects.select(_mode, n, _cand.slot.data()));
+    _cand.gather(_objects);
+    return static_cast<int>(_cand.count);
 }
 
 
 
-//Ƹڻеġ¶ȡһҪԵָ꣩ݶڲͬʱ¶ȡ
-void tdcCache::agent_estimate_temp(const list<object_c>::iterator& it, int* temp) {
-    *temp = 0;
-    if (hit_set->checkBit(it->oid))
-        *temp = 1000000;
-    unsigned i = 0;
-    int last_n = hit_set_search_last_n;
-    for (map<time_t, BloomFilter>::reverse_iterator p = hit_set_map.rbegin(); last_n > 0 && p != hit_set_map.rend(); ++p, ++i) {
-        if (p->second.checkBit(it->oid)) {
-            *temp += get_grade(i);
-            --last_n;
+//ƺѡڻеġ¶ȡһҪԵָ꣩ݶڲͬʱ¶ȡ
+//Ȳ Bloom filter õÿѡλλѡۼӷֵ
+void tdcCache::agent_estimate_temp() {
+    size_t n = _cand.count;
+    unsigned history = min<unsigned>(hit_set_count, 7);
+    for (size_t k = 0; k < n; ++k) {
+        int32_t oid = _cand.oid[k];
+        uint8_t bits = hit_set->checkBit(oid) ? 1 : 0;
+        unsigned i = 0;
+        int last_n = hit_set_search_last_n;
+        for (map<time_t, BloomFilter>::reverse_iterator p = hit_set_map.rbegin(); last_n > 0 && i < history && p != hit_set_map.rend(); ++p, ++i) {
+            if (p->second.checkBit(oid)) {
+                bits |= static_cast<uint8_t>(2u << i);
+                --last_n;
+            }
+        }
+        _cand.hit_bits[k] = bits;
+    }
+    const uint8_t* bits = _cand.hit_bits.data();
+    int32_t* temp = _cand.temp.data();
+    for (size_t k = 0; k < n; ++k) {
+        temp[k] = (bits[k] & 1) * 1000000;
+    }
+    for (unsigned i = 0; i < history; ++i) {
+        int32_t grade = static_cast<int32_t>(get_grade(i));
+        for (size_t k = 0; k < n; ++k) {
+            temp[k] += ((bits[k] >> (i + 1)) & 1) * grade;
         }
     }
 }
@@ -191,10 +150,13 @@ void tdcCache::renew_hit_set() {
     hit_set = bf;
 }
 
-void tdcCache::statics() {
-    cout << "trace:" << _file_name << " tdc_cache:"
+std::string tdcCache::statics() {
+    std::stringstream s;
+    s << "trace:" << _file_name << " tdc_cache:"
         << "\tcache_size:" << _capacity
         << "\trequest:" << _get_count
         << "\thit:" << _hit_count
-        << "\thit_rate: " << 1.0 * _hit_count / _get_count << endl;
+        << "\thit_rate: " << 1.0 * _hit_count / _get_count
+        << "\tdensity_kernel:" << density_kernel_name() << endl;
+    return s.str();
 }
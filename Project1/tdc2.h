@@ -1,4 +1,5 @@
 
+#pragma once
 #include "tiercache.h"
 #include <unordered_map>
 #include <list>
@@ -7,51 +8,59 @@
 #include <chrono>
 using namespace std;
 
+// ѡѡȡͬ CephTierCacheobject_slots + candidate_batch
+// 䰴ʴʱ䣩ƣѡܶ density_kernel 
 class tdcCache {
 private:
-    list<object_c> obj_set;//
-    map<int, list<object_c>::iterator> obj_map;
+    object_slots _objects;
+    candidate_batch _cand;
+    candidate_mode _mode;
     vector<uint32_t> grade_table;
-    pow2_hist_t temp_hist;
     BloomFilter* hit_set;
     int _capacity;
     int _current_size;
     int _hit_count;
     int _get_count;
+    unsigned int _eviction_count;
+    uint64_t _clock = 0;   // ʱ䣬ÿ get һ
     std::string _file_name;
 
-    double cache_min_evict_age = 0.8;
+    int32_t cache_min_evict_age = 1;    // ʴƣδĶ̭
     uint32_t hit_set_count = 3;
     uint32_t hit_set_grade_decay_rate = 20;
     uint32_t bloomfilter_max = 100000;
     uint32_t hit_set_search_last_n = 3;
     map<time_t, BloomFilter> hit_set_map;
-    unsigned evict_effort = 0;
     double osd_pool_default_cache_max_evict_check_size = 0.00001;
-    list<object_c>::iterator _next;
+    size_t min_evict_check = 32;        // ÿѡޣС水ֻѡ 1 
 
 public:
     uint32_t get_grade(unsigned i) const;
     void calc_grade_table();
     bool get(int oid, int size);
 
-    void agent_estimate_temp(const list<object_c>::iterator& it, int* temp);
-    bool agent_maybe_evict(vector<list<object_c>::iterator>& ls);
-    int objects_list_partial(vector<list<object_c>::iterator>& ls);
+    //  _cand кѡ¶
+    void agent_estimate_temp();
+    bool agent_maybe_evict();
+    // ѡһѡд _candظ
+    int objects_list_partial();
     bool agent_work();
     void renew_hit_set();
-    void statics();
+    std::string statics();
+    unsigned int hit_count() const { return static_cast<unsigned int>(_hit_count); }
+    unsigned int eviction_count() const { return _eviction_count; }
+    size_t size() const { return _objects.count(); }
+    void reset_stats() { _hit_count = _get_count = 0; _eviction_count = 0; }
 
-    explicit tdcCache(int size, string fliename) {
+    explicit tdcCache(int size, string fliename, candidate_mode mode = candidate_mode::SWEEP) {
+        this->_mode = mode;
         this->_capacity = size;
         this->_file_name = fliename;
         this->hit_set = new BloomFilter(bloomfilter_max);
         this->_current_size = 0;
         this->_hit_count = 0;
         this->_get_count = 0;
+        this->_eviction_count = 0;
         calc_grade_table();
-        obj_set.clear();
-        obj_map.clear();
-        _next = obj_set.begin();
     }
 };
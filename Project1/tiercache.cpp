@@ -1,9 +1,12 @@
 #include "tiercache.h"
+#include "alloc_counter.h"
 #include <chrono>
 #include <list>
 #include <map>
 #include <iostream>
 #include <cassert> 
+#include <algorithm>
+#include <sstream>
 using namespace std;
 using namespace std::chrono;
 //grade_table,еÿԪشͬдµķֵʼֵΪ1000000ÿμhit_set_grade_decay_rateٷֱȡ
@@ -23,127 +26,225 @@ uint32_t CephTierCache::get_grade(unsigned i) const {
     return grade_table[i];
 }
 //Ļȡ,_get_countж϶ǷڻУУδУ¶󲢿ܴagent_work()άֻС
+//첽ģʽֻڳˮλʱѺ̨߳
 bool CephTierCache::get(int oid, int size) {
+    auto lock = index_lock();
     ++_get_count;
-    object_c obj(oid, size);
-    if (obj_map.find(oid) != obj_map.end()) {
+    if (_objects.contains(oid)) {
         ++_hit_count;
-        hit_set->setBit(obj.oid);
+        hit_set->setBit(oid);
         return true;
     }
-    _current_size += obj.size;
-    if (_current_size > _capacity) {
+    if (_async) {
+        agent_reserve(lock, size);
+    }
+    _current_size += size;
+    bool wake = false;
+    if (_async) {
+        double step = _capacity * osd_pool_default_cache_max_evict_check_size;
+        if (_current_size > _capacity * _high_ratio && !_agent_busy && !_agent_wakeup &&
+            (_stall_size == 0 || _current_size >= _stall_size + step)) {
+            _agent_wakeup = true;
+            wake = true;
+        }
+    }
+    else if (_current_size > _capacity) {
         agent_work();
     }
-    obj_set.push_front(obj);
-    obj_map[oid] = obj_set.begin();
-    hit_set->setBit(obj.oid);
+    _objects.insert(oid, size, static_cast<int64_t>(system_clock::now().time_since_epoch().count()));
+    hit_set->setBit(oid);
+    _peak_size = max(_peak_size, _current_size);
 
     if (hit_set->remain_capacity() <= 0) {
         renew_hit_set();
     }
-    assert(obj_map.size() == obj_set.size());
+    if (wake) {
+        lock.unlock();
+        _agent_cond.notify_one();
+    }
     return true;
 }
 
-//ġ¶ȡһȼҪԵĶʷ
-void CephTierCache::agent_estimate_temp(const list<object_c>::iterator& it, int* temp) {
-    *temp = 0;
-    if (hit_set->checkBit(it->oid))
-        *temp = 1000000;
-    unsigned i = 0;
-    int last_n = hit_set_search_last_n;
-    for (map<time_t, BloomFilter>::reverse_iterator p = hit_set_map.rbegin(); last_n > 0 && p != hit_set_map.rend(); ++p, ++i) {
-        if (p->second.checkBit(it->oid)) {
-            *temp += get_grade(i);
-            --last_n;
+void CephTierCache::start_agent(double high, double low) {
+    if (_async) {
+        return;
+    }
+    _high_ratio = high;
+    _low_ratio = min(low, high);
+    _agent_stop = false;
+    _agent_wakeup = false;
+    _async = true;
+    // ̵̨߳ķ䣨̭ʱʱȣǵĲ˻
+    mem_ledger* owner = mem_ledger_acquire(current_mem_ledger());
+    _agent = std::thread([this, owner] {
+        {
+            mem_scope scope(owner);
+            agent_loop();
         }
+        mem_ledger_release(owner);
+    });
+}
+
+void CephTierCache::stop_agent() {
+    if (!_async) {
+        return;
     }
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _agent_stop = true;
+    }
+    _agent_cond.notify_one();
+    _space_cond.notify_all();
+    _agent.join();
+    _async = false;
 }
 
-//һֶбЩܻᱻ
-int CephTierCache::objects_list_partial(vector<list<object_c>::iterator>& ls) {
-    int n = obj_map.size() * osd_pool_default_cache_max_evict_check_size;//ҪѡĶ
-    n = max(1, n);//֤ٴһ
-    ls.resize(n);//ĴС
-    auto it = _next; // ʹþֲ޸ _next ״̬
-    for (int i = 0; i < n; ++i) {
-        // ȷûе obj_set ĩβ
-        if (it == obj_set.end()) {
-            it = obj_set.begin(); // ĩβ¿ʼ
-        }
+//̫»̫ʱ̨̻֣߳ʱУͬģʽһ£
+void CephTierCache::agent_reserve(std::unique_lock<std::mutex>& lock, int size) {
+    if (_current_size + size <= _capacity || _stall_size > 0) {
+        return;
+    }
+    ++_full_waits;
+    unsigned int rounds = _agent_rounds;
+    if (!_agent_busy) {
+        _agent_wakeup = true;
+        _agent_cond.notify_one();
+    }
+    _space_cond.wait(lock, [&] {
+        return _current_size + size <= _capacity || _agent_rounds != rounds || _agent_stop;
+    });
+}
 
-        // 鵱ǰǷ obj_map 
-        if (obj_map.find(it->oid) == obj_map.end()) {
-            //  obj_map Уͨʾ߼
-            // Ӵ߼
+//̨̭̣߳ÿ agent_work() ֻһСζ֮ͷǰ̨ get() 롣
+//ɨԼһȦṷ̂κζ󣨶̫»̫ȣʱ֣һλ
+void CephTierCache::agent_loop() {
+    size_t sweep = static_cast<size_t>(1 / osd_pool_default_cache_max_evict_check_size) + 1;
+    std::unique_lock<std::mutex> lock(_lock);
+    while (true) {
+        _agent_cond.wait(lock, [this] { return _agent_stop || _agent_wakeup; });
+        if (_agent_stop) {
             break;
         }
+        _agent_wakeup = false;
+        _agent_busy = true;
+        _stall_size = 0;
+        ++_agent_wakeups;
+        size_t idle = 0;
+        while (!_agent_stop && _current_size > _capacity * _low_ratio && !_objects.empty() && idle < sweep) {
+            if (agent_work()) {
+                idle = 0;
+                _space_cond.notify_all();
+            }
+            else {
+                ++idle;
+            }
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+        _stall_size = idle >= sweep ? _current_size : 0;
+        _agent_busy = false;
+        ++_agent_rounds;
+        _space_cond.notify_all();
+    }
+}
 
-        ls.push_back(it); // ӵ ls
-
-        // ƶһԪأȷԽ
-        ++it;
-        if (it == obj_set.end() && i < n - 1) {
-            it = obj_set.begin(); // ֹһԪغи
+//ѡġ¶ȡʷ
+// Bloom filter õλ 0 λΪǰ hit set i λΪǰ i ʷ hit set
+//λѡۼӷֵڶѭֻ飬
+void CephTierCache::agent_estimate_temp() {
+    size_t n = _cand.count;
+    unsigned history = min<unsigned>(hit_set_count, 7);
+    for (size_t k = 0; k < n; ++k) {
+        int32_t oid = _cand.oid[k];
+        uint8_t bits = hit_set->checkBit(oid) ? 1 : 0;
+        unsigned i = 0;
+        int last_n = hit_set_search_last_n;
+        for (map<time_t, BloomFilter>::reverse_iterator p = hit_set_map.rbegin(); last_n > 0 && i < history && p != hit_set_map.rend(); ++p, ++i) {
+            if (p->second.checkBit(oid)) {
+                bits |= static_cast<uint8_t>(2u << i);
+                --last_n;
+            }
         }
+        _cand.hit_bits[k] = bits;
     }
-    //  _next ΪһεĿʼ
-    _next = it;
-    return n; // ѡ
+    const uint8_t* bits = _cand.hit_bits.data();
+    int32_t* temp = _cand.temp.data();
+    for (size_t k = 0; k < n; ++k) {
+        temp[k] = (bits[k] & 1) * 1000000;
+    }
+    for (unsigned i = 0; i < history; ++i) {
+        int32_t grade = static_cast<int32_t>(get_grade(i));
+        for (size_t k = 0; k < n; ++k) {
+            temp[k] += ((bits[k] >> (i + 1)) & 1) * grade;
+        }
+    }
+}
+
+//ѡһѡΪ osd_pool_default_cache_max_evict_check_size 1 
+//ԪݰиƵ _cand˳ɨʱϴελü
+int CephTierCache::objects_list_partial() {
+    size_t n = max<size_t>(1, static_cast<size_t>(_objects.count() * osd_pool_default_cache_max_evict_check_size));
+    _cand.resize(n);
+    _cand.resize(_objects.select(_mode, n, _cand.slot.data()));
+    _cand.gather(_objects);
+    return static_cast<int>(_cand.count);
 }
 
-//ݴobjects_list_partial()õĺѡб,ִʵʵ
+//objects_list_partial()ѡĺѡִж
 bool CephTierCache::agent_work() {
-    vector<list<object_c>::iterator> ls;
-    int selectedCount = objects_list_partial(ls);
+    if (objects_list_partial() == 0) {
+        return false;
+    }
+    if (hit_set) {
+        agent_estimate_temp();
+    }
+    else {
+        fill(_cand.temp.begin(), _cand.temp.begin() + _cand.count, 0);
+    }
+    int64_t now = static_cast<int64_t>(system_clock::now().time_since_epoch().count());
     bool workExecuted = false;
-
-    // ڳǰӡ ls еĶϢ
-    std::cout << "Selected objects for possible eviction:" << std::endl;
-    for (int i = 0; i < ls.size(); ++i) {
-        // õ object_c 󣬲ӡ oid  size
-        object_c& obj = *(ls[i]); // ע˫ؽ
-        std::cout << "Object ID: " << obj.oid << ", Size: " << obj.size << std::endl;
-
-        if (agent_maybe_evict(ls[i])) {
+    for (size_t i = 0; i < _cand.count; ++i) {
+        if (agent_maybe_evict(i, now)) {
             workExecuted = true;
         }
     }
-
     return workExecuted; // Ƿɹִй
 }
-//жǷӦôӻƳض漰ġ¶ȡԼǷ̫»̫ȡʣ
-bool CephTierCache::agent_maybe_evict(list<object_c>::iterator& it) {
-    // ʹ std::chrono ȡǰʱ
-    auto now = system_clock::now();
-    //  object_c е mtime Ѿ޸Ϊ std::chrono::system_clock::time_point 
-    auto obj_local_mtime = it->mtime;
-    // ʱǷ"̫"
-    // cache_min_evict_age ҪΪλĳʱ
-    if (obj_local_mtime + seconds(static_cast<long long>(cache_min_evict_age)) > now) {
+//жǷӦôӻƳ i ѡ漰ġ¶ȡԼǷ̫»̫ȡʣ
+bool CephTierCache::agent_maybe_evict(size_t i, int64_t now) {
+    // cache_min_evict_age Ϊλԭһض
+    int64_t min_age = duration_cast<system_clock::duration>(seconds(static_cast<long long>(cache_min_evict_age))).count();
+    if (_cand.mtime[i] + min_age > now) {
         // ޸ʱСڵǰʱ䣬
         return false;
     }
-    int temp = 0;
+    int temp = _cand.temp[i];
     uint64_t temp_upper = 0, temp_lower = 0;
-    if (hit_set)
-        agent_estimate_temp(it, &temp);
     temp_hist.add(temp);
 
     temp_hist.get_position_micro(temp, &temp_lower, &temp_upper);
     if (1000000 - temp_upper <= evict_effort) {
-        // cout<<__func__<<" skip (too hot) "<<it->oid<<" "<<temp<<" upper: "<<temp_upper<<endl;
         return false;
     }
-    // cout<<__func__<<"\t"<<it->oid<<"\t"<<temp<<"\t"<<temp_upper<<endl;
-    if (obj_map.find(it->oid) == obj_map.end()) {
+    // ʱͬһܳΣѱ
+    int64_t s = _objects.find(_cand.oid[i]);
+    if (s < 0) {
         return false;
     }
-    _current_size -= it->size;
-    auto temp_it = obj_map[it->oid];
-    obj_map.erase(it->oid);    //map<int, list<object_c>::iterator> obj_map;
-    _next = obj_set.erase(temp_it);   //list<object_c> obj_set;
+    _current_size -= _objects.size[s];
+    _objects.remove(static_cast<uint32_t>(s));
+    ++_eviction_count;
+    return true;
+}
+bool CephTierCache::erase(int oid) {
+    auto lock = index_lock();
+    int64_t s = _objects.find(oid);
+    if (s < 0) {
+        return false;
+    }
+    _current_size -= _objects.size[s];
+    _objects.remove(static_cast<uint32_t>(s));
     return true;
 }
 //мϵʱµмϣɵݡ
@@ -156,10 +257,98 @@ void CephTierCache::renew_hit_set() {
     hit_set = bf;
 }
 
-void CephTierCache::statics() {
-    cout << "trace:" << _file_name << " ceph_tier_cache:"
+std::string CephTierCache::statics() {
+    auto lock = index_lock();
+    std::stringstream s;
+    s << "trace:" << _file_name << (_async ? " ceph_tier_async_cache:" : " ceph_tier_cache:")
         << "\tcache_size:" << _capacity
         << "\trequest:" << _get_count
         << "\thit:" << _hit_count
-        << "\thit_rate: " << 1.0 * _hit_count / _get_count << endl;
+        << "\thit_rate: " << 1.0 * _hit_count / _get_count
+        << "\tpeak_size:" << _peak_size
+        << "\tcandidates:" << (_mode == candidate_mode::RANDOM ? "random" : "sweep");
+    if (_async) {
+        s << "\thigh:" << _high_ratio << "\tlow:" << _low_ratio << "\twakeups:" << _agent_wakeups
+            << "\tfull_waits:" << _full_waits;
+    }
+    s << endl;
+    return s.str();
+}
+
+// 󰴲λ˳򱣴Ϊ (oid, size, mtime) Ԫ飬mtime Ϊ system_clock  tick ɨλüΪλ
+void CephTierCache::save(snapshot_writer& w) const {
+    auto lock = index_lock();
+    w.begin("ceph_tier");
+    w.put<double>(_capacity);
+    w.put<double>(_current_size);
+    w.put<double>(_hit_count);
+    w.put<double>(_get_count);
+    w.put<uint32_t>(_eviction_count);
+    std::vector<int32_t> objs;
+    objs.reserve(_objects.count() * 2);
+    for (size_t i = 0; i < _objects.count(); ++i) {
+        objs.push_back(_objects.oid[i]);
+        objs.push_back(_objects.size[i]);
+    }
+    w.put_vector(objs);
+    w.put_vector(_objects.mtime);
+    w.put<uint64_t>(_objects.cursor());
+    hit_set->save(w);
+    w.put<uint64_t>(hit_set_map.size());
+    for (const auto& p : hit_set_map) {
+        w.put<int64_t>(static_cast<int64_t>(p.first));
+        p.second.save(w);
+    }
+    w.put_vector(temp_hist.h);
+}
+
+bool CephTierCache::load(snapshot_reader& r) {
+    auto lock = index_lock();
+    double capacity = 0, current_size = 0, hit = 0, get = 0;
+    uint32_t evicted = 0;
+    std::vector<int32_t> objs;
+    std::vector<int64_t> mtimes;
+    uint64_t next_index = 0, sets = 0;
+    if (!r.expect("ceph_tier") || !r.get(capacity) || !r.get(current_size) || !r.get(hit) ||
+        !r.get(get) || !r.get(evicted) || !r.get_vector(objs) || !r.get_vector(mtimes) ||
+        !r.get(next_index) || capacity != _capacity || objs.size() != mtimes.size() * 2) {
+        return false;
+    }
+    _objects.clear();
+    for (size_t i = 0; i < mtimes.size(); ++i) {
+        _objects.insert(objs[2 * i], objs[2 * i + 1], mtimes[i]);
+    }
+    _objects.set_cursor(static_cast<size_t>(next_index));
+    if (!hit_set->load(r) || !r.get(sets)) {
+        return false;
+    }
+    hit_set_map.clear();
+    for (uint64_t i = 0; i < sets; ++i) {
+        int64_t t = 0;
+        BloomFilter bf(bloomfilter_max);
+        if (!r.get(t) || !bf.load(r)) {
+            return false;
+        }
+        hit_set_map.emplace_hint(hit_set_map.end(), static_cast<time_t>(t), bf);
+    }
+    if (!r.get_vector(temp_hist.h)) {
+        return false;
+    }
+    _current_size = current_size;
+    _peak_size = current_size;
+    _hit_count = hit;
+    _get_count = get;
+    _eviction_count = evicted;
+    return true;
+}
+
+bool CephTierCache::save(const std::string& path) const {
+    snapshot_writer w;
+    save(w);
+    return w.write_file(path);
+}
+
+bool CephTierCache::load(const std::string& path) {
+    snapshot_reader r;
+    return r.read_file(path) && load(r);
 }
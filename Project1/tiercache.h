@@ -1,38 +1,31 @@
 #pragma once
 #include <chrono> // ȷͷļ
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <set>
 #include <map>
 #include "bloomfilter.h"
 #include "histogram.h"
+#include "object_slots.h"
+#include "snapshot.h"
 
 using namespace std;
 
-class object_c {
-public:
-    std::chrono::system_clock::time_point mtime; // ʹ std::chrono ¼ʱ
-    int oid;
-    int size; 
-    object_c(int oid, int size) {
-        mtime = chrono::system_clock::now(); // ȡǰʱ
-        this->oid = oid;
-        this->size = size;
-    }
-    // 캯ʹõǰʱʼ mtime
-    /*object_c(int oid, int size) : oid(oid), size(size) {
-        mtime = std::chrono::system_clock::now();
-    }*/
-    bool operator<(const object_c& p) const {
-        return this->oid > p.oid;
-    }
-};
-
 
+// Ĭ̭ͬ󳬹 get() е agent_work()
+// 첽ģʽstart_agent ceph_tier_async Ceph  tiering agent һɺ̨̭߳
+// ռóˮλʱѣ agent_work() ֱڵˮλǰ̨ get() ֻͼ¼У
+// ᳬʱǰ̨ȴ̨߳ڳռ䣨൱ Ceph  cache_target_full_ratio
+// ʱhit set ¶ֱͼ _lock ٿɸ
+//  object_slots Уÿ agent_work()  _mode ѡһѡ˳ɨ
 class CephTierCache {
 private:
-    list<object_c> obj_set;
-    map<int, list<object_c>::iterator> obj_map;
+    object_slots _objects;
+    candidate_batch _cand;
+    candidate_mode _mode;
     vector<uint32_t> grade_table;
     pow2_hist_t temp_hist;
     BloomFilter* hit_set;
@@ -40,6 +33,7 @@ private:
     double _current_size;
     double _hit_count;
     double _get_count;
+    unsigned int _eviction_count;
     std::string _file_name;
 
     double cache_min_evict_age = 0.8;
@@ -50,30 +44,85 @@ private:
     map<time_t, BloomFilter> hit_set_map;
     unsigned evict_effort = 5000;
     double osd_pool_default_cache_max_evict_check_size = 0.005;
-    list<object_c>::iterator _next;
+
+    bool _async = false;
+    double _high_ratio = 1.0;
+    double _low_ratio = 1.0;
+    bool _agent_stop = false;
+    bool _agent_wakeup = false;
+    bool _agent_busy = false;
+    std::thread _agent;
+    mutable std::mutex _lock;
+    std::condition_variable _agent_cond;
+    std::condition_variable _space_cond;   // ̨̭߳˶һ
+    double _peak_size = 0;            // ռõֵӳ̭ϲʱĳ
+    unsigned int _agent_wakeups = 0;
+    unsigned int _agent_rounds = 0;
+    unsigned int _full_waits = 0;     // ǰ̨򻺴ȴĴ
+    // ̨߳һ̫»̫ȶʱռãΪ 0˺ǰ̨ٵȴ
+    // ռһεĴС»Ѻ̨߳
+    double _stall_size = 0;
+
+    void agent_loop();
+    // 첽ģʽ²ǰãŲʱѺ̨̲߳ȴֱڳռ̨߳̽һ
+    void agent_reserve(std::unique_lock<std::mutex>& lock, int size);
+    // 첽ģʽ¼ͬģʽ·δе
+    std::unique_lock<std::mutex> index_lock() const {
+        return _async ? std::unique_lock<std::mutex>(_lock) : std::unique_lock<std::mutex>(_lock, std::defer_lock);
+    }
 
 public:
     uint32_t get_grade(unsigned i) const;
     void calc_grade_table();
     bool get(int oid, int size);
 
-    void agent_estimate_temp(const list<object_c>::iterator& it, int* temp);
-    bool agent_maybe_evict(list<object_c>::iterator& it);
-    int objects_list_partial(vector<list<object_c>::iterator>& ls);
+    //  _cand кѡ¶
+    void agent_estimate_temp();
+    // жǷ i ѡnow Ϊ system_clock  tick 
+    bool agent_maybe_evict(size_t i, int64_t now);
+    // ѡһѡд _candظ
+    int objects_list_partial();
     bool agent_work();
     void renew_hit_set();
-    void statics();
+    std::string statics();
+    unsigned int hit_count() const { return static_cast<unsigned int>(_hit_count); }
+    unsigned int eviction_count() const { auto lock = index_lock(); return _eviction_count; }
+    // գλ˳Ķ󣨺 mtimeɨλáǰ hit setʷ hit set ¶ֱͼ
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+    void save(snapshot_writer& w) const;
+    bool load(snapshot_reader& r);
+    size_t size() const { auto lock = index_lock(); return _objects.count(); }
+    // ༶ռģʽѯǷפ hit setƳ
+    bool contains(int oid) const { auto lock = index_lock(); return _objects.contains(oid); }
+    bool erase(int oid);
+    void reset_stats() {
+        auto lock = index_lock();
+        _hit_count = _get_count = 0;
+        _eviction_count = _agent_wakeups = _full_waits = 0;
+        _peak_size = _current_size;
+    }
+
+    // ̨̭̣߳ռó high  ʱѣ̭ low  £ʱκ
+    void start_agent(double high = 0.9, double low = 0.8);
+    // ̨֪ͨ߳˳ȴ֮ص̭ͬ
+    void stop_agent();
+
+    ~CephTierCache() { stop_agent(); }
 
-    explicit CephTierCache(int size, string fliename) {
+    explicit CephTierCache(int size, string fliename, bool async_agent = false,
+        candidate_mode mode = candidate_mode::SWEEP) {
+        this->_mode = mode;
         this->_capacity = size;
         this->_file_name = fliename;
         this->hit_set = new BloomFilter(bloomfilter_max);
         this->_current_size = 0;
         this->_hit_count = 0;
         this->_get_count = 0;
+        this->_eviction_count = 0;
         calc_grade_table();
-        obj_set.clear();
-        obj_map.clear();
-        _next = obj_set.begin();
+        if (async_agent) {
+            start_agent();
+        }
     }
 };
@@ -0,0 +1,240 @@
+#pragma once
+// W-TinyLFU 准入过滤：频率草图 + 门卫布隆过滤器 + 小窗口 LRU，可包裹任意提供
+// contains()/victim()/get() 的策略（LRUCache、ARCCache）
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bloomfilter.h"
+#include "memory_resource.h"
+
+// 4 位计数器的 count-min sketch：每个 uint64_t 存 16 个计数器，深度为 4
+// 累计 sample_size 次增量后所有计数器减半，使频率随时间衰减
+class FrequencySketch {
+public:
+    explicit FrequencySketch(int capacity) {
+        size_t n = 1;
+        while (n < static_cast<size_t>(std::max(1, capacity)))
+            n <<= 1;
+        _table.assign(n, 0);
+        _mask = n - 1;
+        _sample_size = 10 * std::max(1, capacity);
+        _additions = 0;
+        _resets = 0;
+    }
+
+    // 频率加一，4 个计数器都已饱和时不计入样本
+    bool increment(int key) {
+        uint64_t h = hash(key);
+        bool added = false;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t& word = _table[index_of(h, i)];
+            int shift = offset_of(h, i);
+            if (((word >> shift) & 0xf) < 15) {
+                word += 1ULL << shift;
+                added = true;
+            }
+        }
+        if (added && ++_additions >= _sample_size)
+            reset();
+        return added;
+    }
+
+    // 取 4 个计数器的最小值作为估计频率
+    int frequency(int key) const {
+        uint64_t h = hash(key);
+        int freq = 15;
+        for (int i = 0; i < 4; ++i) {
+            int c = static_cast<int>((_table[index_of(h, i)] >> offset_of(h, i)) & 0xf);
+            freq = std::min(freq, c);
+        }
+        return freq;
+    }
+
+    // 所有计数器减半（老化）
+    void reset() {
+        for (auto& word : _table)
+            word = (word >> 1) & 0x7777777777777777ULL;
+        _additions /= 2;
+        ++_resets;
+    }
+
+    int sample_size() const { return _sample_size; }
+    // 已经减半的次数，调用者据此得知草图何时老化
+    uint64_t resets() const { return _resets; }
+
+private:
+    static uint64_t hash(int key) {
+        uint64_t x = static_cast<uint32_t>(key) * 0x9e3779b97f4a7c15ULL;
+        x ^= x >> 32;
+        x *= 0xd6e8feb86659fd93ULL;
+        return x ^ (x >> 32);
+    }
+    size_t index_of(uint64_t h, int i) const {
+        uint64_t x = (h + 0x9e3779b97f4a7c15ULL * (i + 1)) * 0xbf58476d1ce4e5b9ULL;
+        return static_cast<size_t>(x >> 32) & _mask;
+    }
+    static int offset_of(uint64_t h, int i) {
+        return static_cast<int>((h >> (i * 4)) & 0xf) << 2;
+    }
+
+    std::vector<uint64_t> _table;
+    size_t _mask;
+    int _sample_size;
+    int _additions;
+    uint64_t _resets;
+};
+
+// TinyLFU：门卫过滤器挡住只出现一次的对象，第二次访问起才进入草图
+// 门卫按草图两次减半之间的增量数（sample_size / 2）确定大小，约 6 字节/条目
+class TinyLFU {
+public:
+    explicit TinyLFU(int capacity) :
+        _sketch(capacity), _doorkeeper(doorkeeper_size()), _resets(0) {}
+
+    void record(int key) {
+        if (!_doorkeeper.checkBit(key)) {
+            // 门卫装满后误判率会失控，提前清空
+            if (_doorkeeper.remain_capacity() == 0) {
+                clear_doorkeeper();
+            }
+            _doorkeeper.setBit(key);
+            return;
+        }
+        _sketch.increment(key);
+        // 草图减半时门卫也一起清空
+        if (_sketch.resets() != _resets) {
+            _resets = _sketch.resets();
+            clear_doorkeeper();
+        }
+    }
+
+    int frequency(int key) const {
+        return _sketch.frequency(key) + (_doorkeeper.checkBit(key) ? 1 : 0);
+    }
+
+    // 候选者频率高于淘汰对象时才准入
+    bool admit(int candidate, int victim) const {
+        return frequency(candidate) > frequency(victim);
+    }
+
+private:
+    void clear_doorkeeper() {
+        _doorkeeper = BloomFilter(doorkeeper_size());
+    }
+    // 稳定状态下草图每 sample_size / 2 次增量减半一次
+    int doorkeeper_size() const { return std::max(1, _sketch.sample_size() / 2); }
+
+    FrequencySketch _sketch;
+    BloomFilter _doorkeeper;
+    uint64_t _resets;   // 上次清空门卫时草图的减半次数
+};
+
+// W-TinyLFU 包装器：新对象先进入容量约 1% 的窗口 LRU，被窗口挤出的候选者
+// 与主策略的淘汰对象比较频率，胜者留在主策略中
+template <class Policy>
+class WTinyLFUCache {
+public:
+    explicit WTinyLFUCache(int c, std::string file_name, std::string name = "wtinylfu_cache",
+        double window_ratio = 0.01, policy_allocator alloc = current_policy_allocator()) :
+        _resource(make_policy_resource(alloc)),
+        _capacity(c),
+        _window_capacity(c > 1 ? std::max(1, static_cast<int>(c * window_ratio)) : 0),
+        _window(_resource.get()), _window_table(0, _resource.get()),
+        _main(c - _window_capacity, file_name, alloc),
+        _filter(c),
+        _file_name(file_name), _name(name),
+        _hit_count(0), _get_count(0), _miss_count(0), _rejected_count(0) {}
+
+    WTinyLFUCache(const WTinyLFUCache&) = delete;
+    WTinyLFUCache& operator=(const WTinyLFUCache&) = delete;
+
+    int get(int target) {
+        if (_capacity <= 0) {
+            return -1;
+        }
+        ++_get_count;
+        _filter.record(target);
+
+        auto it = _window_table.find(target);
+        if (it != _window_table.end()) {
+            ++_hit_count;
+            _window.splice(_window.begin(), _window, it->second);
+            return target;
+        }
+        if (_main.contains(target)) {
+            ++_hit_count;
+            return _main.get(target);
+        }
+
+        ++_miss_count;
+        if (_window_capacity == 0) {
+            admit(target);
+            return target;
+        }
+        _window.push_front(target);
+        _window_table[target] = _window.begin();
+        if (static_cast<int>(_window.size()) > _window_capacity) {
+            int candidate = _window.back();
+            _window_table.erase(candidate);
+            _window.pop_back();
+            admit(candidate);
+        }
+        return target;
+    }
+
+    unsigned int hit_count() const { return _hit_count; }
+    // 主策略的淘汰加上被拒绝准入的候选者（它们同样离开了缓存）
+    unsigned int eviction_count() const { return _main.eviction_count() + _rejected_count; }
+    size_t size() const { return _window.size() + _main.size(); }
+    void reset_stats() {
+        _main.reset_stats();
+        _hit_count = _get_count = _miss_count = _rejected_count = 0;
+    }
+
+    bool contains(int target) const {
+        return _window_table.count(target) != 0 || _main.contains(target);
+    }
+
+    std::string statics() {
+        std::stringstream s;
+        s << "trace:" << _file_name << " " << _name << ":"
+            << " cache_size:" << _capacity
+            << " request:" << _get_count
+            << " hit:" << _hit_count
+            << " miss:" << _miss_count
+            << " rejected:" << _rejected_count
+            << " hit_rate:" << 1.0 * _hit_count / _get_count << std::endl;
+        return s.str();
+    }
+
+private:
+    // 主策略未满时直接放入，否则由 TinyLFU 决定候选者是否替换淘汰对象
+    void admit(int candidate) {
+        int victim = _main.victim();
+        if (victim < 0 || _filter.admit(candidate, victim)) {
+            _main.get(candidate);
+        }
+        else {
+            ++_rejected_count;
+        }
+    }
+
+    std::unique_ptr<memory_resource> _resource;  // 窗口链表和哈希表用
+    int _capacity;
+    int _window_capacity;
+    resource_list<int> _window;
+    resource_map<int, resource_list<int>::iterator> _window_table;
+    Policy _main;
+    TinyLFU _filter;
+    std::string _file_name;
+    std::string _name;
+    unsigned int _hit_count;
+    unsigned int _get_count;
+    unsigned int _miss_count;
+    unsigned int _rejected_count;
+};
@@ -0,0 +1,70 @@
+#include "trace_source.h"
+#include <algorithm>
+#include <ctime>
+#include <vector>
+#include <iostream>
+#include "csv_trace.h"
+#include "synth_trace.h"
+#include "trc.h"
+
+bool TextTraceSource::open(const char* path) {
+    return fopen_s(&_file, path, "r") == 0;
+}
+
+bool TextTraceSource::next(trace_line& l) {
+    if (fscanf_s(_file, "%d %d %d %d\n",
+        &l.starting_block, &l.size_of_blocks, &l.ignore, &l.request_number) != 4) {
+        return false;
+    }
+    l.current_time = time(nullptr);  // 使用系统当前时间
+    l.access_count = 0;  // 初始化访问次数为0
+    return true;
+}
+
+uint64_t TextTraceSource::length() {
+    uint64_t pos = file_tell64(_file);
+    std::vector<char> buf(1 << 20);
+    uint64_t lines = 0;
+    size_t n;
+    char last = '\n';
+    while ((n = fread(buf.data(), 1, buf.size(), _file)) > 0) {
+        lines += static_cast<uint64_t>(std::count(buf.data(), buf.data() + n, '\n'));
+        last = buf[n - 1];
+    }
+    if (last != '\n') {
+        ++lines;  // 最后一行没有换行符
+    }
+    file_seek64(_file, pos);
+    return lines;
+}
+
+std::unique_ptr<TraceSource> open_trace(const std::string& name) {
+    if (name.compare(0, 6, "synth:") == 0) {
+        std::unique_ptr<SyntheticTraceSource> synth(new SyntheticTraceSource());
+        std::string error;
+        if (!synth->parse(name.substr(6), &error)) {
+            std::cerr << "bad synthetic trace spec: " << error << std::endl;
+            return nullptr;
+        }
+        return synth;
+    }
+    bool matched = false;
+    std::unique_ptr<TraceSource> csv = open_csv_trace(name, &matched);
+    if (matched) {
+        return csv;
+    }
+    if (name.size() >= 4 && name.compare(name.size() - 4, 4, ".trc") == 0) {
+        std::unique_ptr<TrcTraceSource> trc(new TrcTraceSource());
+        std::string error;
+        if (!trc->open(name.c_str(), &error)) {
+            std::cerr << error << std::endl;
+            return nullptr;
+        }
+        return trc;
+    }
+    std::unique_ptr<TextTraceSource> text(new TextTraceSource());
+    if (!text->open(name.c_str())) {
+        return nullptr;
+    }
+    return text;
+}
@@ -0,0 +1,101 @@
+#pragma once
+// trace 来源接口：文件 trace 与合成负载都通过它逐条产出 trace_line，供同一个模拟循环使用
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TraceLine.h"
+#include "file_offset.h"
+
+class TraceSource {
+public:
+    virtual ~TraceSource() {}
+    // 读取下一条记录，没有更多记录时返回 false
+    virtual bool next(trace_line& l) = 0;
+    // 批量读取，返回实际读到的条数（0 表示结束）
+    virtual size_t next_batch(trace_line* out, size_t n) {
+        size_t i = 0;
+        while (i < n && next(out[i])) {
+            ++i;
+        }
+        return i;
+    }
+    // trace 的总行数，未知时返回 0（按比例设置预热长度时用）
+    virtual uint64_t length() { return 0; }
+    // 跳过 n 条记录（从检查点恢复时用），返回实际跳过的条数
+    virtual uint64_t skip(uint64_t n) {
+        trace_line buf[256];
+        uint64_t skipped = 0;
+        while (skipped < n) {
+            size_t want = n - skipped < 256 ? static_cast<size_t>(n - skipped) : 256;
+            size_t got = next_batch(buf, want);
+            if (got == 0) {
+                break;
+            }
+            skipped += got;
+        }
+        return skipped;
+    }
+};
+
+// "<starting_block> <size_of_blocks> <ignore> <request_number>" 格式的文本 trace
+class TextTraceSource : public TraceSource {
+public:
+    TextTraceSource() : _file(nullptr) {}
+    ~TextTraceSource() {
+        if (_file) {
+            fclose(_file);
+        }
+    }
+    TextTraceSource(const TextTraceSource&) = delete;
+    TextTraceSource& operator=(const TextTraceSource&) = delete;
+
+    bool open(const char* path);
+    bool next(trace_line& l) override;
+    // 从当前位置扫描到文件尾统计换行数，再回到原位置
+    uint64_t length() override;
+
+private:
+    FILE* _file;
+};
+
+// 已解码到内存的 trace：多个模拟共享同一份只读记录，各自持有读取位置
+class MemoryTraceSource : public TraceSource {
+public:
+    explicit MemoryTraceSource(const std::vector<trace_line>& lines) : _lines(&lines), _pos(0) {}
+
+    bool next(trace_line& l) override {
+        if (_pos >= _lines->size()) {
+            return false;
+        }
+        l = (*_lines)[_pos++];
+        return true;
+    }
+    size_t next_batch(trace_line* out, size_t n) override {
+        size_t left = _lines->size() - _pos;
+        if (n > left) {
+            n = left;
+        }
+        std::copy(_lines->begin() + _pos, _lines->begin() + _pos + n, out);
+        _pos += n;
+        return n;
+    }
+    uint64_t length() override { return _lines->size() - _pos; }
+    uint64_t skip(uint64_t n) override {
+        size_t left = _lines->size() - _pos;
+        size_t k = n < left ? static_cast<size_t>(n) : left;
+        _pos += k;
+        return k;
+    }
+
+private:
+    const std::vector<trace_line>* _lines;
+    size_t _pos;
+};
+
+// 按名字打开 trace：以 "synth:" 开头的是合成负载，msr: / twitter: / meta: 为公开格式（见 csv_trace.h），
+// .trc 为压缩 trace，否则按文本 trace 文件打开；失败返回 nullptr
+std::unique_ptr<TraceSource> open_trace(const std::string& name);
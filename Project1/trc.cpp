@@ -0,0 +1,391 @@
+#include "trc.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+const char kMagic[4] = { 'C', 'P', 'T', 'R' };
+const uint32_t kVersion = 1;
+const size_t kColumns = 4;   // starting_block, size_of_blocks, ignore, request_number
+const size_t kFooterBytes = 8 + 8 + 4 + 4 + 4;
+const size_t kIndexEntryBytes = 8 + 4 + 4;
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+template <class T>
+void put_raw(std::vector<uint8_t>& out, T v) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <class T>
+T get_raw(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+/**
+ * 解码一列 n 个 varint，必须恰好用完 [p, end)；第 i 个值交给 store(i, v)
+ * 按 8 字节一组检查最高位：整组都没有续位时（小差值、小长度的常见情况）直接展开 8 个值；
+ * 遇到多字节的值再逐字节解码。值直接写进 trace_line 的字段，不经过临时数组
+ */
+template <class Store>
+bool decode_column(const uint8_t* p, const uint8_t* end, size_t n, Store store) {
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 8 && end - p >= 8 && (get_raw<uint64_t>(p) & 0x8080808080808080ULL) == 0) {
+            for (int k = 0; k < 8; ++k) {
+                store(i + k, p[k]);
+            }
+            p += 8;
+            i += 8;
+            continue;
+        }
+        uint64_t v = 0;
+        int shift = 0;
+        while (true) {
+            if (p == end || shift > 63) {
+                return false;
+            }
+            uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        store(i++, v);
+    }
+    return p == end;
+}
+
+void encode_chunk(const std::vector<trace_line>& lines, std::vector<uint8_t>& out) {
+    std::vector<uint8_t> columns[kColumns];
+    int64_t prev_block = 0, prev_request = 0;
+    for (const auto& l : lines) {
+        put_varint(columns[0], zigzag(static_cast<int64_t>(l.starting_block) - prev_block));
+        put_varint(columns[1], zigzag(l.size_of_blocks));
+        put_varint(columns[2], zigzag(l.ignore));
+        put_varint(columns[3], zigzag(static_cast<int64_t>(l.request_number) - prev_request));
+        prev_block = l.starting_block;
+        prev_request = l.request_number;
+    }
+    out.clear();
+    put_raw<uint32_t>(out, static_cast<uint32_t>(lines.size()));
+    for (const auto& c : columns) {
+        put_raw<uint32_t>(out, static_cast<uint32_t>(c.size()));
+    }
+    for (const auto& c : columns) {
+        out.insert(out.end(), c.begin(), c.end());
+    }
+}
+
+bool decode_chunk(const uint8_t* p, size_t bytes, uint32_t count, trace_line* out, time_t now) {
+    const size_t head = 4 + 4 * kColumns;
+    if (bytes < head || get_raw<uint32_t>(p) != count) {
+        return false;
+    }
+    size_t lengths[kColumns];
+    size_t total = head;
+    for (size_t c = 0; c < kColumns; ++c) {
+        lengths[c] = get_raw<uint32_t>(p + 4 + 4 * c);
+        total += lengths[c];
+    }
+    if (total != bytes) {
+        return false;
+    }
+    const uint8_t* blocks = p + head;
+    const uint8_t* sizes = blocks + lengths[0];
+    const uint8_t* ignores = sizes + lengths[1];
+    const uint8_t* requests = ignores + lengths[2];
+    // 差值列按顺序累加，解码本身就是顺序的，累加放在同一趟里
+    int64_t block = 0;
+    int64_t request = 0;
+    return decode_column(blocks, sizes, count, [&](size_t i, uint64_t v) {
+            block += unzigzag(v);
+            out[i].starting_block = static_cast<int>(block);
+            out[i].access_count = 0;
+            out[i].current_time = now;  // 与文本 trace 一致，使用读取时的系统时间
+        }) &&
+        decode_column(sizes, ignores, count, [&](size_t i, uint64_t v) {
+            out[i].size_of_blocks = static_cast<int>(unzigzag(v));
+        }) &&
+        decode_column(ignores, requests, count, [&](size_t i, uint64_t v) {
+            out[i].ignore = static_cast<int>(unzigzag(v));
+        }) &&
+        decode_column(requests, requests + lengths[3], count, [&](size_t i, uint64_t v) {
+            request += unzigzag(v);
+            out[i].request_number = static_cast<int>(request);
+        });
+}
+
+} // namespace
+
+TrcTraceSource::TrcTraceSource(int threads) :
+    _file(nullptr), _next_chunk(0), _pos(0), _total(0), _consumed(0),
+    _threads(threads > 0 ? static_cast<size_t>(threads) : std::max(1u, std::thread::hardware_concurrency())),
+    _job_generation(0), _stop(false), _job_first(0), _job_last(0), _job_next(0), _job_done(0), _job_now(0) {}
+
+TrcTraceSource::~TrcTraceSource() {
+    {
+        std::lock_guard<std::mutex> lock(_job_lock);
+        _stop = true;
+    }
+    _job_cond.notify_all();
+    for (auto& t : _workers) {
+        t.join();
+    }
+    if (_file) {
+        fclose(_file);
+    }
+}
+
+bool TrcTraceSource::open(const char* path, std::string* error) {
+    if (fopen_s(&_file, path, "rb") != 0 || !_file) {
+        _file = nullptr;
+        *error = std::string("can't open ") + path;
+        return false;
+    }
+    uint8_t head[8];
+    uint8_t footer[kFooterBytes];
+    if (fread(head, 1, sizeof(head), _file) != sizeof(head) || std::memcmp(head, kMagic, 4) != 0 ||
+        get_raw<uint32_t>(head + 4) != kVersion ||
+        file_seek64(_file, 0, SEEK_END) != 0 || file_tell64(_file) < sizeof(head) + kFooterBytes ||
+        file_seek64(_file, file_tell64(_file) - kFooterBytes, SEEK_SET) != 0 ||
+        fread(footer, 1, kFooterBytes, _file) != kFooterBytes || std::memcmp(footer + 24, kMagic, 4) != 0) {
+        *error = std::string(path) + " is not a .trc file";
+        return false;
+    }
+    uint64_t file_bytes = file_tell64(_file);
+    uint64_t index_offset = get_raw<uint64_t>(footer);
+    _total = get_raw<uint64_t>(footer + 8);
+    uint32_t chunks = get_raw<uint32_t>(footer + 16);
+    // 索引必须正好位于数据段之后、footer 之前
+    if (index_offset < sizeof(head) || index_offset > file_bytes - kFooterBytes ||
+        static_cast<uint64_t>(chunks) * kIndexEntryBytes != file_bytes - kFooterBytes - index_offset) {
+        *error = std::string(path) + ": truncated index";
+        return false;
+    }
+    std::vector<uint8_t> raw(static_cast<size_t>(chunks) * kIndexEntryBytes);
+    if (file_seek64(_file, index_offset, SEEK_SET) != 0 || fread(raw.data(), 1, raw.size(), _file) != raw.size()) {
+        *error = std::string(path) + ": truncated index";
+        return false;
+    }
+    _index.resize(chunks);
+    uint64_t sum = 0;
+    uint64_t next = sizeof(head);
+    for (uint32_t i = 0; i < chunks; ++i) {
+        const uint8_t* e = raw.data() + i * kIndexEntryBytes;
+        _index[i].offset = get_raw<uint64_t>(e);
+        _index[i].bytes = get_raw<uint32_t>(e + 8);
+        _index[i].count = get_raw<uint32_t>(e + 12);
+        // 各段首尾相接地铺满 [8, index_offset)，读取时按相对偏移切 _raw，不再逐段检查
+        if (_index[i].offset != next || _index[i].bytes > index_offset - next) {
+            *error = std::string(path) + ": corrupt chunk index";
+            return false;
+        }
+        next += _index[i].bytes;
+        sum += _index[i].count;
+    }
+    if (next != index_offset) {
+        *error = std::string(path) + ": corrupt chunk index";
+        return false;
+    }
+    if (sum != _total) {
+        *error = std::string(path) + ": index does not match record count";
+        return false;
+    }
+    return true;
+}
+
+void TrcTraceSource::worker_loop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(_job_lock);
+    while (true) {
+        _job_cond.wait(lock, [&] { return _stop || _job_generation != seen; });
+        if (_stop) {
+            return;
+        }
+        seen = _job_generation;
+        lock.unlock();
+        drain_job();
+        lock.lock();
+    }
+}
+
+void TrcTraceSource::drain_job() {
+    std::unique_lock<std::mutex> lock(_job_lock);
+    while (_job_next < _job_last) {
+        size_t k = _job_next++;
+        lock.unlock();
+        const chunk_info& c = _index[k];
+        size_t i = k - _job_first;
+        _job_ok[i] = decode_chunk(_raw.data() + (c.offset - _index[_job_first].offset), c.bytes, c.count,
+            _lines.data() + _job_starts[i], _job_now);
+        lock.lock();
+        if (++_job_done == _job_last - _job_first) {
+            _done_cond.notify_one();
+        }
+    }
+}
+
+// 一次读入连续的若干段（段在文件中首尾相接，一次 fread），再交给常驻线程按段解码
+bool TrcTraceSource::fill() {
+    if (_next_chunk >= _index.size()) {
+        return false;
+    }
+    size_t first = _next_chunk;
+    size_t last = std::min(_index.size(), first + _threads);
+    uint64_t begin = _index[first].offset;
+    uint64_t end = _index[last - 1].offset + _index[last - 1].bytes;
+    _raw.resize(static_cast<size_t>(end - begin));
+    if (file_seek64(_file, begin, SEEK_SET) != 0 || fread(_raw.data(), 1, _raw.size(), _file) != _raw.size()) {
+        std::cerr << "trc: truncated chunk " << first << std::endl;
+        _next_chunk = _index.size();
+        return false;
+    }
+    _job_starts.assign(last - first + 1, 0);
+    for (size_t k = first; k < last; ++k) {
+        _job_starts[k - first + 1] = _job_starts[k - first] + _index[k].count;
+    }
+    _lines.resize(_job_starts.back());
+    _pos = 0;
+    _job_ok.assign(last - first, 0);
+    _job_now = time(nullptr);
+
+    if (last - first > 1 && _workers.empty()) {
+        for (size_t t = 1; t < _threads; ++t) {
+            _workers.emplace_back(&TrcTraceSource::worker_loop, this);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(_job_lock);
+        _job_first = first;
+        _job_last = last;
+        _job_done = 0;
+        _job_next = first;
+        ++_job_generation;
+    }
+    if (!_workers.empty()) {
+        _job_cond.notify_all();
+    }
+    drain_job();
+    {
+        std::unique_lock<std::mutex> lock(_job_lock);
+        _done_cond.wait(lock, [&] { return _job_done == last - first; });
+    }
+
+    _next_chunk = last;
+    for (size_t k = first; k < last; ++k) {
+        if (!_job_ok[k - first]) {
+            std::cerr << "trc: corrupt chunk " << k << std::endl;
+            _lines.resize(_job_starts[k - first]);
+            _next_chunk = _index.size();
+            break;
+        }
+    }
+    return !_lines.empty();
+}
+
+bool TrcTraceSource::next(trace_line& l) {
+    return next_batch(&l, 1) == 1;
+}
+
+size_t TrcTraceSource::next_batch(trace_line* out, size_t n) {
+    if (_pos >= _lines.size() && !fill()) {
+        return 0;
+    }
+    size_t k = std::min(n, _lines.size() - _pos);
+    std::copy(_lines.begin() + _pos, _lines.begin() + _pos + k, out);
+    _pos += k;
+    _consumed += k;
+    return k;
+}
+
+uint64_t TrcTraceSource::skip(uint64_t n) {
+    uint64_t skipped = std::min<uint64_t>(n, _lines.size() - _pos);
+    _pos += static_cast<size_t>(skipped);
+    while (skipped < n && _next_chunk < _index.size() && _index[_next_chunk].count <= n - skipped) {
+        skipped += _index[_next_chunk++].count;
+    }
+    _consumed += skipped;
+    if (skipped < n && fill()) {
+        uint64_t k = std::min<uint64_t>(n - skipped, _lines.size());
+        _pos = static_cast<size_t>(k);
+        _consumed += k;
+        skipped += k;
+    }
+    return skipped;
+}
+
+bool write_trc(TraceSource& source, const std::string& path, std::string* error, uint32_t chunk_records) {
+    FILE* f = nullptr;
+    if (fopen_s(&f, path.c_str(), "wb") != 0 || !f) {
+        *error = "can't write " + path;
+        return false;
+    }
+    std::vector<uint8_t> buf;
+    buf.insert(buf.end(), kMagic, kMagic + 4);
+    put_raw<uint32_t>(buf, kVersion);
+    bool ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    uint64_t offset = buf.size();
+    uint64_t total = 0;
+    std::vector<uint8_t> index;
+    uint32_t chunks = 0;
+    std::vector<trace_line> lines(chunk_records);
+    size_t n;
+    while (ok) {
+        // next_batch 可能一次只返回一部分，凑满一段再编码
+        n = 0;
+        size_t got;
+        while (n < lines.size() && (got = source.next_batch(lines.data() + n, lines.size() - n)) > 0) {
+            n += got;
+        }
+        if (n == 0) {
+            break;
+        }
+        lines.resize(n);
+        encode_chunk(lines, buf);
+        ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+        put_raw<uint64_t>(index, offset);
+        put_raw<uint32_t>(index, static_cast<uint32_t>(buf.size()));
+        put_raw<uint32_t>(index, static_cast<uint32_t>(n));
+        offset += buf.size();
+        total += n;
+        ++chunks;
+        if (n < chunk_records) {
+            break;
+        }
+    }
+    buf.clear();
+    put_raw<uint64_t>(buf, offset);
+    put_raw<uint64_t>(buf, total);
+    put_raw<uint32_t>(buf, chunks);
+    put_raw<uint32_t>(buf, chunk_records);
+    buf.insert(buf.end(), kMagic, kMagic + 4);
+    ok = ok && fwrite(index.data(), 1, index.size(), f) == index.size() &&
+        fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    if (fclose(f) != 0 || !ok) {
+        *error = "write to " + path + " failed";
+        return false;
+    }
+    return true;
+}
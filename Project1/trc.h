@@ -0,0 +1,82 @@
+#pragma once
+// 压缩 trace 格式（.trc）：按块分段，每段约 64K 条记录，可独立解码
+//
+// 文件布局：
+//   "CPTR" 版本号
+//   段 0 .. 段 k-1
+//   索引：每段 { 文件偏移, 字节数, 记录数 }
+//   尾部：索引偏移, 总记录数, 段数, 每段记录数, "CPTR"
+// 段内按列存放：starting_block、request_number 存与上一条的差值，ignore、size_of_blocks 存原值，
+// 四列都经 zigzag 后写成 varint；每段的差值从 0 开始，所以任一段都能单独解码
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trace_source.h"
+
+class TrcTraceSource : public TraceSource {
+public:
+    // threads：并行解码的段数（含调用线程），0 表示按硬件线程数
+    explicit TrcTraceSource(int threads = 0);
+    ~TrcTraceSource();
+    TrcTraceSource(const TrcTraceSource&) = delete;
+    TrcTraceSource& operator=(const TrcTraceSource&) = delete;
+
+    // 读取尾部和索引，格式不对返回 false
+    bool open(const char* path, std::string* error);
+    bool next(trace_line& l) override;
+    size_t next_batch(trace_line* out, size_t n) override;
+    uint64_t length() override { return _total - _consumed; }
+    // 整段跳过时只移动索引位置，不读取数据
+    uint64_t skip(uint64_t n) override;
+
+private:
+    struct chunk_info {
+        uint64_t offset;
+        uint32_t bytes;
+        uint32_t count;
+    };
+
+    // 读入并并行解码接下来的一组段，没有更多数据时返回 false
+    bool fill();
+    // 解码线程主循环：等待新的一组段，领取段号解码，直到 _stop
+    void worker_loop();
+    // 从本组领取段号逐个解码，领完返回；主线程和解码线程都调用
+    void drain_job();
+
+    FILE* _file;
+    std::vector<chunk_info> _index;
+    size_t _next_chunk;           // 下一个要读入的段
+    std::vector<uint8_t> _raw;    // 本组段的原始字节，跨 fill() 复用
+    std::vector<trace_line> _lines;  // 已解码、尚未交出的记录
+    size_t _pos;
+    uint64_t _total;
+    uint64_t _consumed;
+    size_t _threads;
+
+    // 常驻解码线程（_threads - 1 个，第一次 fill() 时创建）。每组段的编号放在
+    // [_job_first, _job_last)，各线程在锁内从 _job_next 领取一段、锁外解码，主线程同样参与。
+    // 一段约 64K 条记录，每段加一次锁的开销可以忽略
+    std::vector<std::thread> _workers;
+    std::mutex _job_lock;
+    std::condition_variable _job_cond;    // 有新的一组段，或者要退出
+    std::condition_variable _done_cond;   // 本组段全部解码完
+    uint64_t _job_generation;
+    bool _stop;
+    size_t _job_first;
+    size_t _job_last;
+    size_t _job_next;                     // 以下两项受 _job_lock 保护
+    size_t _job_done;                     // 本组已解码完的段数
+    std::vector<size_t> _job_starts;      // 每段在 _lines 中的起始位置
+    std::vector<char> _job_ok;
+    time_t _job_now;
+};
+
+// 把任意 trace 来源写成 .trc；chunk_records 为每段记录数
+bool write_trc(TraceSource& source, const std::string& path, std::string* error,
+    uint32_t chunk_records = 65536);
@@ -0,0 +1,266 @@
+#pragma once
+// 固定种子的合成访问序列：均匀、Zipf（分段别名表采样）、顺序扫描、循环、混合
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// xoshiro256** 随机数发生器，用 splitmix64 展开种子
+class FastRng {
+public:
+    explicit FastRng(uint64_t seed = 42) {
+        for (int i = 0; i < 4; ++i) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            _s[i] = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+        const uint64_t t = _s[1] << 17;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 45);
+        return result;
+    }
+
+    // [0, 1) 上的均匀分布
+    double next_double() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // [0, n) 上的均匀整数（乘法取高位，无取模）
+    uint64_t next_below(uint64_t n) {
+        uint64_t x = next() >> 32;
+        return (x * n) >> 32;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+    uint64_t _s[4];
+};
+
+// Zipf 分布采样：查表，不做 log/exp
+// 排名分成若干段：前 kHead 个排名每个一段，之后每段宽度为起点的 1/64（几何分桶），
+// 各段按概率质量建一张 Vose 别名表。一次 64 位随机数同时给出段号、别名判定和段内均匀偏移。段内首尾概率之比不超过 (1 + 1/64)^alpha，即段内近似带来的偏差约 1%；
+// 各段的总质量是精确的（宽段用 Euler-Maclaurin 公式求和）。n = 1e8 时约 5000 段，表在 L2 内
+// 返回 [1, n] 上的排名，排名越小越热
+class ZipfGenerator {
+public:
+    ZipfGenerator(uint64_t n, double alpha) : _n(n < 1 ? 1 : n), _alpha(alpha) {
+        build();
+    }
+
+    uint64_t sample(FastRng& rng) const {
+        // 高 32 位乘段数：积的高位是段号，低位在段内均匀分布，用作别名判定；
+        // 低 32 位给出段内偏移。宽度为 1 的段偏移恒为 0，不单独分支
+        uint64_t r = rng.next();
+        uint64_t x = (r >> 32) * _prob.size();
+        uint64_t i = x >> 32;
+        uint32_t seg = static_cast<uint32_t>(x) < _prob[i] ? static_cast<uint32_t>(i) : _alias[i];
+        return _start[seg] + (((r & 0xffffffffULL) * _width[seg]) >> 32);
+    }
+
+private:
+    static const uint64_t kHead = 4096;
+    static const int kWidthShift = 6;     // 段宽 = 起点 >> 6
+    static const uint64_t kExactSum = 64; // 不超过此宽度的段逐项求和
+
+    void build() {
+        std::vector<double> mass;
+        for (uint64_t a = 1; a <= _n;) {
+            uint64_t width = a <= kHead ? 1 : a >> kWidthShift;
+            if (width > _n - a + 1) {
+                width = _n - a + 1;
+            }
+            uint64_t b = a + width - 1;
+            double m = 0;
+            if (width <= kExactSum) {
+                for (uint64_t k = a; k <= b; ++k) {
+                    m += h(static_cast<double>(k));
+                }
+            }
+            else {
+                double x = static_cast<double>(a), y = static_cast<double>(b);
+                m = h_integral(y) - h_integral(x) + 0.5 * (h(x) + h(y)) + _alpha / 12.0 * (h(x) / x - h(y) / y);
+            }
+            _start.push_back(a);
+            _width.push_back(static_cast<uint32_t>(width));
+            mass.push_back(m);
+            a = b + 1;
+        }
+
+        // Vose 别名表，概率按 2^32 定点
+        size_t count = mass.size();
+        double total = 0;
+        for (double m : mass) {
+            total += m;
+        }
+        _prob.assign(count, 0);
+        _alias.assign(count, 0);
+        std::vector<double> scaled(count);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < count; ++i) {
+            scaled[i] = mass[i] * count / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t l = small.back(), g = large.back();
+            small.pop_back();
+            large.pop_back();
+            _prob[l] = static_cast<uint32_t>(scaled[l] * 4294967295.0);
+            _alias[l] = g;
+            scaled[g] = (scaled[g] + scaled[l]) - 1.0;
+            (scaled[g] < 1.0 ? small : large).push_back(g);
+        }
+        for (uint32_t i : large) {
+            _prob[i] = 0xffffffffU;
+            _alias[i] = i;
+        }
+        for (uint32_t i : small) {
+            _prob[i] = 0xffffffffU;
+            _alias[i] = i;
+        }
+    }
+
+    double h(double x) const {
+        return std::exp(-_alpha * std::log(x));
+    }
+    // h 的原函数：alpha = 1 时为 log(x)
+    double h_integral(double x) const {
+        double log_x = std::log(x);
+        return helper2((1.0 - _alpha) * log_x) * log_x;
+    }
+    // expm1(x)/x，x 接近 0 时用泰勒展开
+    static double helper2(double x) {
+        return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+    }
+
+    uint64_t _n;
+    double _alpha;
+    std::vector<uint32_t> _prob;
+    std::vector<uint32_t> _alias;
+    std::vector<uint64_t> _start;
+    std::vector<uint32_t> _width;
+};
+
+enum WorkloadKind {
+    WL_UNIFORM,
+    WL_ZIPF,
+    WL_SCAN,
+    WL_LOOP,
+    WL_MIXED,
+};
+
+// 按访问模式逐个生成块号，不缓存整条序列
+class KeyStream {
+public:
+    // universe：热点集合大小；scan_ratio 只对 WL_MIXED 有效
+    KeyStream(WorkloadKind kind, uint64_t universe, double alpha = 0.9, uint64_t seed = 42,
+        double scan_ratio = 0.2) :
+        _kind(kind), _universe(universe < 1 ? 1 : universe), _rng(seed),
+        _zipf(_universe, alpha), _scan_ratio(scan_ratio), _pos(0), _rotation(0) {}
+
+    int next() {
+        switch (_kind) {
+        case WL_UNIFORM:
+            return static_cast<int>(_rng.next_below(_universe));
+        case WL_ZIPF:
+            return hot(_zipf.sample(_rng) - 1);
+        case WL_SCAN:
+            // 扫描区间足够大，基本不会重复
+            return static_cast<int>(_universe + (_pos++ % (16 * _universe)));
+        case WL_LOOP:
+            return hot(_pos++ % _universe);
+        case WL_MIXED:
+        default:
+            if (_rng.next_double() < _scan_ratio) {
+                return static_cast<int>(_universe + (_pos++ % (16 * _universe)));
+            }
+            return hot(_zipf.sample(_rng) - 1);
+        }
+    }
+
+    // 连续生成 n 个块号，依次交给 sink(i, key)；常用模式的分支提到循环外
+    template <class Sink>
+    void generate(size_t n, Sink sink) {
+        switch (_kind) {
+        case WL_UNIFORM:
+            for (size_t i = 0; i < n; ++i) {
+                sink(i, static_cast<int>(_rng.next_below(_universe)));
+            }
+            break;
+        case WL_ZIPF:
+            for (size_t i = 0; i < n; ++i) {
+                sink(i, hot(_zipf.sample(_rng) - 1));
+            }
+            break;
+        default:
+            for (size_t i = 0; i < n; ++i) {
+                sink(i, next());
+            }
+            break;
+        }
+    }
+
+    // 热点迁移：排名整体平移半个热点集合，原来的冷对象变热
+    void shift_hot_set() {
+        _rotation = (_rotation + _universe / 2) % _universe;
+    }
+
+    // 生成的块号上界（不含），扫描区间在热点集合之后
+    uint64_t span() const {
+        return 17 * _universe;
+    }
+
+    // 把 "uniform" / "zipf0.9" / "scan" / "loop" / "mixed" 解析为访问模式
+    static bool parse(const std::string& name, WorkloadKind* kind, double* alpha) {
+        *alpha = 0.9;
+        if (name == "uniform") {
+            *kind = WL_UNIFORM;
+        }
+        else if (name.compare(0, 4, "zipf") == 0) {
+            *kind = WL_ZIPF;
+            if (name.size() > 4) {
+                *alpha = std::atof(name.c_str() + 4);
+            }
+        }
+        else if (name == "scan") {
+            *kind = WL_SCAN;
+        }
+        else if (name == "loop") {
+            *kind = WL_LOOP;
+        }
+        else if (name == "mixed") {
+            *kind = WL_MIXED;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    int hot(uint64_t rank) const {
+        uint64_t k = rank + _rotation;
+        return static_cast<int>(k >= _universe ? k - _universe : k);
+    }
+
+    WorkloadKind _kind;
+    uint64_t _universe;
+    FastRng _rng;
+    ZipfGenerator _zipf;
+    double _scan_ratio;
+    uint64_t _pos;
+    uint64_t _rotation;
+};